@@ -0,0 +1,389 @@
+/*
+ * Copyright (C) 2014 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "PowerHAL"
+
+#include "AdaptiveBoostController.h"
+#include "PowerFs.h"
+
+#include <cutils/log.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+static const char* PSI_CPU = "/proc/pressure/cpu";
+static const char* PROC_STAT = "/proc/stat";
+static const char* CPUFREQ_DIR = "/sys/devices/system/cpu/cpufreq";
+static const char* CPU_ONLINE = "/sys/devices/system/cpu/online";
+
+#define NSEC_PER_SEC 1000000000LL
+
+static long long now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+}
+
+AdaptiveBoostController::AdaptiveBoostController():
+    mNumPolicies(0),
+    mPsiFd(-1),
+    mStatFd(-1),
+    mWakeFd(-1),
+    mCb(NULL),
+    mCbArg(NULL),
+    mRunning(false),
+    mLevel(0),
+    mMinLevel(0),
+    mMaxLevel(100),
+    mLastUtil(-1),
+    mSessions(0),
+    mStalls(0),
+    mRaises(0),
+    mLowers(0),
+    mStarted(false),
+    mSampleHist("adaptive_sample")
+{
+    memset(mPolicies, 0, sizeof(mPolicies));
+    mTrigger[0] = '\0';
+    memset(mCpuPolicy, -1, sizeof(mCpuPolicy));
+    pthread_mutex_init(&mLock, NULL);
+}
+
+/* cpufreq lists cpus separated by spaces, cpu lists by commas */
+bool AdaptiveBoostController::addPolicy(const char *cpuList)
+{
+    char list[CPU_LIST_MAX * 4];
+    cpu_mask_t cpus;
+    char *p;
+    size_t cpu;
+
+    if (mNumPolicies >= ADAPTIVE_MAX_POLICIES)
+        return false;
+    snprintf(list, sizeof(list), "%s", cpuList);
+    for (p = list; *p; p++)
+        if (*p == ' ')
+            *p = ',';
+    if (CpuTopology::parseCpuList(list, &cpus) || cpus.none())
+        return false;
+    for (cpu = 0; cpu < CPU_TOPOLOGY_MAX_CPUS; cpu++)
+        if (cpus.test(cpu))
+            mCpuPolicy[cpu] = mNumPolicies;
+    mNumPolicies++;
+    return true;
+}
+
+bool AdaptiveBoostController::setTrigger(int stallUs, int windowUs)
+{
+    int len = snprintf(mTrigger, sizeof(mTrigger), "some %d %d", stallUs, windowUs);
+
+    /* the kernel parses up to the terminating NUL */
+    return write(mPsiFd, mTrigger, len + 1) >= 0;
+}
+
+bool AdaptiveBoostController::probe()
+{
+    PowerFs *fs = PowerFs::get();
+    std::vector<std::string> names;
+    char path[PATH_MAX];
+    char buf[CPU_LIST_MAX * 4];
+    size_t i;
+
+    /* triggers are polled, so this needs a kernel fd rather than PowerFs */
+    mPsiFd = open(PSI_CPU, O_RDWR | O_NONBLOCK | O_CLOEXEC);
+    if (mPsiFd < 0) {
+        ALOGI("No %s, adaptive boost disabled", PSI_CPU);
+        return false;
+    }
+    if (!setTrigger(ADAPTIVE_PSI_STALL_US, ADAPTIVE_PSI_WINDOW_US) &&
+        !setTrigger(ADAPTIVE_PSI_UNPRIV_STALL_US, ADAPTIVE_PSI_UNPRIV_WINDOW_US)) {
+        ALOGW("PSI trigger \"%s\" rejected: %s, adaptive boost disabled", mTrigger,
+              strerror(errno));
+        goto fail;
+    }
+
+    mStatFd = fs->open(PROC_STAT, O_RDONLY | O_CLOEXEC);
+    if (mStatFd < 0) {
+        ALOGW("Could not open %s, adaptive boost disabled", PROC_STAT);
+        goto fail;
+    }
+
+    /* one utilisation per frequency domain; all cpus as one without cpufreq */
+    if (!fs->listDir(CPUFREQ_DIR, &names))
+        for (i = 0; i < names.size(); i++) {
+            if (names[i].compare(0, 6, "policy"))
+                continue;
+            snprintf(path, sizeof(path), "%s/%s/related_cpus", CPUFREQ_DIR, names[i].c_str());
+            if (!fs->readFile(path, buf, sizeof(buf)))
+                addPolicy(buf);
+        }
+    if (!mNumPolicies && !fs->readFile(CPU_ONLINE, buf, sizeof(buf)))
+        addPolicy(buf);
+    if (!mNumPolicies) {
+        ALOGW("No cpus to sample, adaptive boost disabled");
+        goto fail;
+    }
+
+    mWakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (mWakeFd < 0) {
+        ALOGE("Could not create the adaptive boost eventfd: %s", strerror(errno));
+        goto fail;
+    }
+    ALOGI("Adaptive boost on %d policies, PSI trigger \"%s\"", mNumPolicies, mTrigger);
+    return true;
+
+fail:
+    if (mStatFd >= 0)
+        fs->close(mStatFd);
+    mStatFd = -1;
+    close(mPsiFd);
+    mPsiFd = -1;
+    return false;
+}
+
+void AdaptiveBoostController::setLevelCallback(adaptive_level_cb_t cb, void *arg)
+{
+    mCb = cb;
+    mCbArg = arg;
+}
+
+int AdaptiveBoostController::start()
+{
+    if (mStarted || !active())
+        return 0;
+    if (pthread_create(&mThread, NULL, threadLoop, this)) {
+        ALOGE("Could not start the adaptive boost loop");
+        return -1;
+    }
+    mStarted = true;
+    return 0;
+}
+
+void AdaptiveBoostController::wake()
+{
+    uint64_t one = 1;
+
+    if (write(mWakeFd, &one, sizeof(one)) < 0 && errno != EAGAIN)
+        ALOGE("Could not wake the adaptive boost loop: %s", strerror(errno));
+}
+
+/*
+ * Utilisation in percent of the busiest policy since the last call, -1
+ * if /proc/stat could not be read. Called from the loop thread only.
+ */
+int AdaptiveBoostController::sample()
+{
+    unsigned long long busy[ADAPTIVE_MAX_POLICIES];
+    unsigned long long total[ADAPTIVE_MAX_POLICIES];
+    unsigned long long v[8];
+    unsigned long long dBusy, dTotal;
+    char *p, *next, *end;
+    ssize_t len;
+    long cpu;
+    int util = 0;
+    int i, n;
+
+    len = PowerFs::get()->pread(mStatFd, mStatBuf, sizeof(mStatBuf) - 1, 0);
+    if (len <= 0)
+        return -1;
+    mStatBuf[len] = '\0';
+
+    memset(busy, 0, sizeof(busy));
+    memset(total, 0, sizeof(total));
+
+    /* "cpuN user nice system idle iowait irq softirq steal ..." */
+    for (p = mStatBuf; p; p = next) {
+        next = strchr(p, '\n');
+        if (next)
+            *next++ = '\0';
+        if (strncmp(p, "cpu", 3) || p[3] < '0' || p[3] > '9')
+            continue;
+        cpu = strtol(p + 3, &end, 10);
+        if (cpu >= CPU_TOPOLOGY_MAX_CPUS || mCpuPolicy[cpu] < 0)
+            continue;
+        for (n = 0, p = end; n < 8; n++, p = end) {
+            v[n] = strtoull(p, &end, 10);
+            if (end == p)
+                break;
+        }
+        if (n < 8)
+            continue;
+        i = mCpuPolicy[cpu];
+        busy[i] += v[0] + v[1] + v[2] + v[5] + v[6] + v[7];
+        total[i] += v[0] + v[1] + v[2] + v[3] + v[4] + v[5] + v[6] + v[7];
+    }
+
+    for (i = 0; i < mNumPolicies; i++) {
+        dBusy = busy[i] - mPolicies[i].busy;
+        dTotal = total[i] - mPolicies[i].total;
+        if (dTotal && dBusy <= dTotal && (int)(dBusy * 100 / dTotal) > util)
+            util = dBusy * 100 / dTotal;
+        mPolicies[i].busy = busy[i];
+        mPolicies[i].total = total[i];
+    }
+    return util;
+}
+
+void *AdaptiveBoostController::threadLoop(void *arg)
+{
+    AdaptiveBoostController *self = (AdaptiveBoostController *)arg;
+    struct pollfd fds[2];
+    bool baseline = true;
+    bool stall;
+    long long start;
+    uint64_t count;
+    int applied = 0;
+    int level;
+    int util;
+
+    fds[0].fd = self->mWakeFd;
+    fds[0].events = POLLIN;
+    fds[1].fd = self->mPsiFd;
+    fds[1].events = POLLPRI;
+
+    pthread_mutex_lock(&self->mLock);
+    while (1) {
+        if (!self->mRunning) {
+            if (applied && self->mCb) {
+                applied = 0;
+                pthread_mutex_unlock(&self->mLock);
+                self->mCb(0, self->mCbArg);
+                pthread_mutex_lock(&self->mLock);
+                continue;
+            }
+            /* idle: trigger events only clear, at most one per window */
+            pthread_mutex_unlock(&self->mLock);
+            if (poll(fds, 2, -1) > 0 && (fds[0].revents & POLLIN))
+                read(self->mWakeFd, &count, sizeof(count));
+            baseline = true;
+            pthread_mutex_lock(&self->mLock);
+            continue;
+        }
+
+        if (self->mLevel != applied && self->mCb) {
+            applied = self->mLevel;
+            pthread_mutex_unlock(&self->mLock);
+            self->mCb(applied, self->mCbArg);
+            pthread_mutex_lock(&self->mLock);
+            continue;
+        }
+        pthread_mutex_unlock(&self->mLock);
+
+        /* the first sample of a session only sets the counters */
+        if (baseline) {
+            self->sample();
+            baseline = false;
+        }
+        stall = false;
+        util = -1;
+        switch (poll(fds, 2, ADAPTIVE_PERIOD_MS)) {
+        case 0:
+            start = now_ns();
+            util = self->sample();
+            self->mSampleHist.record(now_ns() - start);
+            break;
+        case -1:
+            break;
+        default:
+            if (fds[0].revents & POLLIN)
+                read(self->mWakeFd, &count, sizeof(count));
+            stall = fds[1].revents & POLLPRI;
+            break;
+        }
+
+        pthread_mutex_lock(&self->mLock);
+        if (!self->mRunning)
+            continue;
+        level = self->mLevel;
+        if (stall) {
+            self->mStalls++;
+            level += ADAPTIVE_STALL_STEP_PCT;
+        } else if (util >= 0) {
+            self->mLastUtil = util;
+            /* ramp up fast, give the boost back slowly */
+            if (util >= ADAPTIVE_UTIL_HIGH_PCT)
+                level += ADAPTIVE_STEP_PCT;
+            else if (util < ADAPTIVE_UTIL_LOW_PCT)
+                level -= ADAPTIVE_STEP_PCT / 2;
+        }
+        if (level > self->mMaxLevel)
+            level = self->mMaxLevel;
+        if (level < self->mMinLevel)
+            level = self->mMinLevel;
+        if (level > self->mLevel)
+            self->mRaises++;
+        else if (level < self->mLevel)
+            self->mLowers++;
+        self->mLevel = level;
+    }
+    pthread_mutex_unlock(&self->mLock);
+    return NULL;
+}
+
+void AdaptiveBoostController::begin(int level, int minLevel, int maxLevel)
+{
+    if (!active())
+        return;
+    if (maxLevel < minLevel)
+        maxLevel = minLevel;
+    if (level < minLevel)
+        level = minLevel;
+    if (level > maxLevel)
+        level = maxLevel;
+
+    pthread_mutex_lock(&mLock);
+    mMinLevel = minLevel;
+    mMaxLevel = maxLevel;
+    if (!mRunning) {
+        mRunning = true;
+        mLevel = level;
+        mSessions++;
+    }
+    pthread_mutex_unlock(&mLock);
+    wake();
+}
+
+void AdaptiveBoostController::end()
+{
+    if (!active())
+        return;
+    pthread_mutex_lock(&mLock);
+    mRunning = false;
+    pthread_mutex_unlock(&mLock);
+    wake();
+}
+
+void AdaptiveBoostController::dump(int fd)
+{
+    if (!active()) {
+        dprintf(fd, "adaptive boost: off\n");
+        return;
+    }
+    pthread_mutex_lock(&mLock);
+    dprintf(fd, "adaptive boost: trigger=\"%s\" policies=%d running=%d level=%d range=%d..%d util=%d%% sessions=%u stalls=%u raises=%u lowers=%u\n",
+            mTrigger, mNumPolicies, mRunning, mLevel, mMinLevel, mMaxLevel, mLastUtil, mSessions,
+            mStalls, mRaises, mLowers);
+    pthread_mutex_unlock(&mLock);
+    mSampleHist.dump(fd);
+}
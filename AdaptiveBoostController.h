@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2014 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_ADAPTIVE_BOOST_CONTROLLER_H
+#define ANDROID_ADAPTIVE_BOOST_CONTROLLER_H
+
+#include <pthread.h>
+
+#include "CpuTopology.h"
+#include "LatencyHistogram.h"
+
+#define ADAPTIVE_MAX_POLICIES 64
+/* utilisation sampling period while a session is running */
+#define ADAPTIVE_PERIOD_MS 50
+/* PSI trigger: this much cpu "some" stall within the window raises the level */
+#define ADAPTIVE_PSI_STALL_US 20000
+#define ADAPTIVE_PSI_WINDOW_US 500000
+/* without CAP_SYS_RESOURCE the kernel only takes whole 2s windows */
+#define ADAPTIVE_PSI_UNPRIV_STALL_US 80000
+#define ADAPTIVE_PSI_UNPRIV_WINDOW_US 2000000
+/* busiest policy above HIGH raises the level, below LOW decays it */
+#define ADAPTIVE_UTIL_HIGH_PCT 80
+#define ADAPTIVE_UTIL_LOW_PCT 50
+#define ADAPTIVE_STEP_PCT 10
+#define ADAPTIVE_STALL_STEP_PCT 20
+/* /proc/stat for CPU_TOPOLOGY_MAX_CPUS cpus */
+#define ADAPTIVE_STAT_BUF_SIZE 32768
+
+typedef void (*adaptive_level_cb_t)(int level, void *arg);
+
+/**
+ * Closed-loop boost level for the length of an interaction. A session
+ * starts at the fixed touch level; every period its thread reads the
+ * per-policy utilisation from /proc/stat and steps the level up while the
+ * busiest policy is saturated and down while it has headroom. A PSI cpu
+ * trigger wakes the thread as soon as tasks start stalling, which raises
+ * the level by a larger step without waiting for the next sample. The
+ * HAL asks for a 500ms trigger window and settles for the 2s window the
+ * kernel allows unprivileged callers.
+ *
+ * Between sessions the thread sleeps in poll() on the trigger and an
+ * eventfd, so the loop costs nothing while the user is not touching the
+ * screen and one /proc/stat read per period while they are. Level
+ * changes go to the callback from the controller thread; 0 ends the
+ * session's boost.
+ */
+class AdaptiveBoostController {
+
+  public:
+      AdaptiveBoostController();
+      virtual ~AdaptiveBoostController(){};
+      /* false without /proc/pressure/cpu or a trigger the kernel accepts */
+      bool probe();
+      bool active() const { return mPsiFd >= 0; };
+      void setLevelCallback(adaptive_level_cb_t cb, void *arg);
+      int start();
+      /* start a session at level, kept within [minLevel, maxLevel] */
+      void begin(int level, int minLevel, int maxLevel);
+      void end();
+      void dump(int fd);
+
+  private:
+      /* jiffy counters summed over the policy's cpus at the last sample */
+      struct Policy {
+          unsigned long long busy;
+          unsigned long long total;
+      };
+
+      Policy mPolicies[ADAPTIVE_MAX_POLICIES];
+      int mNumPolicies;
+      char mTrigger[32];
+      /* policy index of each cpu, -1 for cpus outside every policy */
+      signed char mCpuPolicy[CPU_TOPOLOGY_MAX_CPUS];
+      int mPsiFd;
+      int mStatFd;
+      int mWakeFd;
+      adaptive_level_cb_t mCb;
+      void *mCbArg;
+      bool mRunning;
+      int mLevel;
+      int mMinLevel;
+      int mMaxLevel;
+      int mLastUtil;
+      unsigned int mSessions;
+      unsigned int mStalls;
+      unsigned int mRaises;
+      unsigned int mLowers;
+      pthread_mutex_t mLock;
+      pthread_t mThread;
+      bool mStarted;
+      LatencyHistogram mSampleHist;
+      char mStatBuf[ADAPTIVE_STAT_BUF_SIZE];
+
+      bool addPolicy(const char *cpuList);
+      bool setTrigger(int stallUs, int windowUs);
+      int sample();
+      void wake();
+      static void *threadLoop(void *arg);
+};
+#endif  // ANDROID_ADAPTIVE_BOOST_CONTROLLER_H
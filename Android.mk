@@ -31,10 +31,33 @@ LOCAL_MODULE_RELATIVE_PATH := hw
 # main libpower source
 LOCAL_SRC_FILES := power.cpp
 
-# for all devices under /sys/power/power_HAL_suspend
+# filesystem backend, persistent sysfs nodes, async writes, timed boost leases, their
+# arbitration, the per-governor boost backends, the foreground cgroup boost, the GPU boost
+# and the adaptive touch boost loop
+LOCAL_SRC_FILES += PowerFs.cpp \
+                   SysfsNode.cpp \
+                   SysfsActuator.cpp \
+                   BoostScheduler.cpp \
+                   BoostArbiter.cpp \
+                   GovernorBackend.cpp \
+                   CGroupBoostController.cpp \
+                   GpuBoostController.cpp \
+                   AdaptiveBoostController.cpp
+
+# touch classification and prediction, their tunables and hint capture for offline replay
+LOCAL_SRC_FILES += TouchClassifier.cpp \
+                   TouchPredictor.cpp \
+                   PowerTunables.cpp \
+                   HintRecorder.cpp
+
+# for all devices under /sys/power/power_HAL_suspend, the cpusets and the staged screen-off
 LOCAL_SRC_FILES += DevicePowerMonitor.cpp \
                    DevicePowerMonitorInfo.cpp \
-                   CGroupCpusetController.cpp
+                   ScreenStateController.cpp \
+                   CGroupCpusetController.cpp \
+                   CpuTopology.cpp \
+                   EppController.cpp \
+                   SustainedController.cpp
 
 LOCAL_SHARED_LIBRARIES := liblog libcutils libutils libdl libicuuc libicui18n libbinder
 
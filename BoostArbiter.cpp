@@ -0,0 +1,288 @@
+/*
+ * Copyright (C) 2014 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "PowerHAL"
+
+#include "BoostArbiter.h"
+
+#include <cutils/log.h>
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/timerfd.h>
+#include <time.h>
+#include <unistd.h>
+
+#define NSEC_PER_SEC 1000000000LL
+
+static long long now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+}
+
+BoostArbiter::BoostArbiter():
+    mNumKnobs(0),
+    mTimerFd(-1),
+    mArmed(0),
+    mStarted(false)
+{
+    pthread_mutex_init(&mLock, NULL);
+}
+
+int BoostArbiter::addKnob(const char *name, SysfsActuator *actuator, int actuatorId,
+                          int aggregate, int defaultValue)
+{
+    Knob *k;
+
+    if (mStarted || mNumKnobs >= ARBITER_MAX_KNOBS || actuatorId < 0) {
+        ALOGE("Cannot register boost knob %s", name);
+        return -1;
+    }
+
+    k = &mKnobs[mNumKnobs];
+    memset(k, 0, sizeof(*k));
+    k->name = name;
+    k->actuator = actuator;
+    k->actuatorId = actuatorId;
+    k->aggregate = aggregate;
+    k->def = defaultValue;
+    /* the knob is assumed to hold its default until a request arrives */
+    k->applied = defaultValue;
+    return mNumKnobs++;
+}
+
+int BoostArbiter::addKnob(const char *name, BoostApplyFn apply, void *arg,
+                          int aggregate, int defaultValue)
+{
+    Knob *k;
+
+    if (mStarted || mNumKnobs >= ARBITER_MAX_KNOBS || !apply) {
+        ALOGE("Cannot register boost knob %s", name);
+        return -1;
+    }
+
+    k = &mKnobs[mNumKnobs];
+    memset(k, 0, sizeof(*k));
+    k->name = name;
+    k->actuatorId = -1;
+    k->apply = apply;
+    k->applyArg = arg;
+    k->aggregate = aggregate;
+    k->def = defaultValue;
+    k->applied = defaultValue;
+    return mNumKnobs++;
+}
+
+int BoostArbiter::start()
+{
+    char buf[80];
+
+    if (mStarted)
+        return 0;
+
+    mTimerFd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+    if (mTimerFd < 0) {
+        strerror_r(errno, buf, sizeof(buf));
+        ALOGE("Could not create arbiter timer: %s", buf);
+        return -1;
+    }
+    if (pthread_create(&mThread, NULL, threadLoop, this)) {
+        ALOGE("Could not start boost arbiter thread");
+        close(mTimerFd);
+        mTimerFd = -1;
+        return -1;
+    }
+    mStarted = true;
+    return 0;
+}
+
+/* called with mLock held */
+void BoostArbiter::evaluate(Knob *k, long long now)
+{
+    char value[16];
+    int top = -1;
+    int effective = 0;
+    bool any = false;
+    int r;
+
+    for (r = 0; r < ARBITER_MAX_REQUESTERS; r++) {
+        Request *q = &k->req[r];
+
+        if (!q->active)
+            continue;
+        if (q->expiry && q->expiry <= now) {
+            q->active = false;
+            continue;
+        }
+        if (!any || q->priority > top) {
+            top = q->priority;
+            effective = q->value;
+            any = true;
+        } else if (q->priority == top) {
+            if (k->aggregate == AGGREGATE_MAX ? q->value > effective : q->value < effective)
+                effective = q->value;
+        }
+    }
+    if (!any)
+        effective = k->def;
+
+    if (effective == k->applied)
+        return;
+    if (k->apply) {
+        k->apply(effective, k->applyArg);
+        k->applied = effective;
+        k->writes++;
+        return;
+    }
+    snprintf(value, sizeof(value), "%d", effective);
+    if (k->actuator->post(k->actuatorId, value)) {
+        k->applied = effective;
+        k->writes++;
+    }
+}
+
+/* called with mLock held */
+void BoostArbiter::rearm(long long now, bool onlyEarlier)
+{
+    struct itimerspec its;
+    long long earliest = 0;
+    int i, r;
+
+    if (mTimerFd < 0)
+        return;
+
+    for (i = 0; i < mNumKnobs; i++)
+        for (r = 0; r < ARBITER_MAX_REQUESTERS; r++) {
+            Request *q = &mKnobs[i].req[r];
+            if (q->active && q->expiry && (!earliest || q->expiry < earliest))
+                earliest = q->expiry;
+        }
+
+    /* extending a request never needs the timer moved: a wakeup re-arms */
+    if (earliest == mArmed || (onlyEarlier && mArmed && mArmed > now && earliest > mArmed))
+        return;
+    if (onlyEarlier && !earliest)
+        return;
+
+    memset(&its, 0, sizeof(its));
+    its.it_value.tv_sec = earliest / NSEC_PER_SEC;
+    its.it_value.tv_nsec = earliest % NSEC_PER_SEC;
+    timerfd_settime(mTimerFd, TFD_TIMER_ABSTIME, &its, NULL);
+    mArmed = earliest;
+}
+
+void BoostArbiter::request(int knob, int requester, int value, int priority, long long durationNs)
+{
+    long long now = now_ns();
+    Request *q;
+
+    if (knob < 0 || knob >= mNumKnobs || requester < 0 || requester >= ARBITER_MAX_REQUESTERS)
+        return;
+
+    pthread_mutex_lock(&mLock);
+    q = &mKnobs[knob].req[requester];
+    q->active = true;
+    q->value = value;
+    q->priority = priority;
+    q->expiry = durationNs > 0 ? now + durationNs : 0;
+    mKnobs[knob].requests++;
+    evaluate(&mKnobs[knob], now);
+    if (q->expiry)
+        rearm(now, true);
+    pthread_mutex_unlock(&mLock);
+}
+
+void BoostArbiter::cancel(int knob, int requester)
+{
+    if (knob < 0 || knob >= mNumKnobs || requester < 0 || requester >= ARBITER_MAX_REQUESTERS)
+        return;
+
+    pthread_mutex_lock(&mLock);
+    if (mKnobs[knob].req[requester].active) {
+        mKnobs[knob].req[requester].active = false;
+        evaluate(&mKnobs[knob], now_ns());
+    }
+    pthread_mutex_unlock(&mLock);
+}
+
+int BoostArbiter::value(int knob)
+{
+    int value;
+
+    if (knob < 0 || knob >= mNumKnobs)
+        return -1;
+
+    pthread_mutex_lock(&mLock);
+    value = mKnobs[knob].applied;
+    pthread_mutex_unlock(&mLock);
+    return value;
+}
+
+void *BoostArbiter::threadLoop(void *arg)
+{
+    BoostArbiter *self = (BoostArbiter *)arg;
+    uint64_t expirations;
+    long long now;
+    int i;
+
+    while (1) {
+        if (read(self->mTimerFd, &expirations, sizeof(expirations)) < 0) {
+            if (errno == EINTR)
+                continue;
+            ALOGE("Boost arbiter timer read failed (%d)", errno);
+            break;
+        }
+
+        pthread_mutex_lock(&self->mLock);
+        now = now_ns();
+        self->mArmed = 0;
+        for (i = 0; i < self->mNumKnobs; i++)
+            self->evaluate(&self->mKnobs[i], now);
+        self->rearm(now, false);
+        pthread_mutex_unlock(&self->mLock);
+    }
+    return NULL;
+}
+
+void BoostArbiter::dump(int fd)
+{
+    long long now = now_ns();
+    int i, r;
+
+    pthread_mutex_lock(&mLock);
+    dprintf(fd, "boost arbiter:\n");
+    for (i = 0; i < mNumKnobs; i++) {
+        Knob *k = &mKnobs[i];
+
+        dprintf(fd, "  %s: %s value=%d default=%d requests=%u writes=%u\n", k->name,
+                k->aggregate == AGGREGATE_MAX ? "max" : "min", k->applied, k->def,
+                k->requests, k->writes);
+        for (r = 0; r < ARBITER_MAX_REQUESTERS; r++) {
+            Request *q = &k->req[r];
+            if (!q->active || (q->expiry && q->expiry <= now))
+                continue;
+            if (q->expiry)
+                dprintf(fd, "    requester %d: %d prio=%d for %lld ms\n", r, q->value,
+                        q->priority, (q->expiry - now) / 1000000LL);
+            else
+                dprintf(fd, "    requester %d: %d prio=%d\n", r, q->value, q->priority);
+        }
+    }
+    pthread_mutex_unlock(&mLock);
+}
@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2014 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_BOOST_ARBITER_H
+#define ANDROID_BOOST_ARBITER_H
+
+#include <pthread.h>
+
+#include "SysfsActuator.h"
+
+#define ARBITER_MAX_KNOBS 16
+#define ARBITER_MAX_REQUESTERS 16
+
+typedef void (*BoostApplyFn)(int value, void *arg);
+
+/**
+ * Central owner of every level knob that several boost paths share
+ * (schedtune.boost, interactive boost, min/max_perf_pct). Each requester
+ * holds at most one request per knob, with a priority and an optional
+ * expiry. The effective value aggregates the requests of the highest
+ * priority present, max for floors and min for caps, and falls back to
+ * the knob's default when none is left; only a change of the effective
+ * value is posted to the actuator.
+ *
+ * A knob either posts its value to one actuator node or hands it to an
+ * apply callback, for knobs that fan out to several nodes. Callbacks run
+ * under the arbiter lock and must not call back into the arbiter.
+ *
+ * Expiries are served by one timerfd thread. The timer is only moved
+ * earlier on the request path; a wakeup for a request that has since been
+ * extended just re-evaluates and re-arms.
+ */
+class BoostArbiter {
+
+  public:
+      enum {
+          AGGREGATE_MAX = 0,   /* performance floors */
+          AGGREGATE_MIN,       /* caps */
+      };
+      enum {
+          PRIORITY_NORMAL = 0,
+          /* e.g. thermal limits that must win over any boost */
+          PRIORITY_CRITICAL = 10,
+      };
+
+      BoostArbiter();
+      virtual ~BoostArbiter(){};
+      /* Knobs must be registered before start() */
+      int addKnob(const char *name, SysfsActuator *actuator, int actuatorId,
+                  int aggregate, int defaultValue);
+      int addKnob(const char *name, BoostApplyFn apply, void *arg,
+                  int aggregate, int defaultValue);
+      int start();
+      /* durationNs == 0 keeps the request until cancel() */
+      void request(int knob, int requester, int value,
+                   int priority = PRIORITY_NORMAL, long long durationNs = 0);
+      void cancel(int knob, int requester);
+      int value(int knob);
+      void dump(int fd);
+
+  private:
+      struct Request {
+          bool active;
+          int value;
+          int priority;
+          /* absolute CLOCK_MONOTONIC expiry in ns, 0 if none */
+          long long expiry;
+      };
+      struct Knob {
+          const char *name;
+          SysfsActuator *actuator;
+          int actuatorId;
+          BoostApplyFn apply;
+          void *applyArg;
+          int aggregate;
+          int def;
+          int applied;
+          unsigned int requests;
+          unsigned int writes;
+          Request req[ARBITER_MAX_REQUESTERS];
+      };
+
+      Knob mKnobs[ARBITER_MAX_KNOBS];
+      int mNumKnobs;
+      pthread_mutex_t mLock;
+      int mTimerFd;
+      /* expiry the timer is armed for, 0 if disarmed */
+      long long mArmed;
+      bool mStarted;
+      pthread_t mThread;
+
+      void evaluate(Knob *k, long long now);
+      void rearm(long long now, bool onlyEarlier);
+      static void *threadLoop(void *arg);
+};
+#endif  // ANDROID_BOOST_ARBITER_H
@@ -0,0 +1,232 @@
+/*
+ * Copyright (C) 2014 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "PowerHAL"
+
+#include "BoostScheduler.h"
+
+#include <cutils/log.h>
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <time.h>
+#include <unistd.h>
+
+#define NSEC_PER_SEC 1000000000LL
+
+static long long now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+}
+
+BoostScheduler::BoostScheduler():
+    mNumLeases(0),
+    mEpollFd(-1),
+    mStarted(false)
+{
+}
+
+int BoostScheduler::addLease(const char *name, lease_cb_t onStart, lease_cb_t onExpire, void *arg)
+{
+    char buf[80];
+    Lease *l;
+
+    if (mStarted || mNumLeases >= BOOST_MAX_LEASES) {
+        ALOGE("Cannot register boost lease %s", name);
+        return -1;
+    }
+
+    l = &mLeases[mNumLeases];
+    l->timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (l->timerFd < 0) {
+        strerror_r(errno, buf, sizeof(buf));
+        ALOGE("Could not create timer for lease %s: %s", name, buf);
+        return -1;
+    }
+    l->name = name;
+    l->onStart = onStart;
+    l->onExpire = onExpire;
+    l->arg = arg;
+    pthread_mutex_init(&l->lock, NULL);
+    l->active = false;
+    l->expiry = 0;
+    l->startTime = 0;
+    l->durations = new LatencyHistogram(name, LATENCY_UNIT_MS);
+    return mNumLeases++;
+}
+
+int BoostScheduler::start()
+{
+    struct epoll_event ev;
+    char buf[80];
+    int i;
+
+    if (mStarted)
+        return 0;
+
+    mEpollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (mEpollFd < 0) {
+        strerror_r(errno, buf, sizeof(buf));
+        ALOGE("Could not create boost epoll: %s", buf);
+        return -1;
+    }
+
+    for (i = 0; i < mNumLeases; i++) {
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN;
+        ev.data.u32 = i;
+        if (epoll_ctl(mEpollFd, EPOLL_CTL_ADD, mLeases[i].timerFd, &ev)) {
+            strerror_r(errno, buf, sizeof(buf));
+            ALOGE("Could not watch lease %s: %s", mLeases[i].name, buf);
+        }
+    }
+
+    if (pthread_create(&mThread, NULL, threadLoop, this)) {
+        ALOGE("Could not start boost scheduler thread");
+        close(mEpollFd);
+        mEpollFd = -1;
+        return -1;
+    }
+    mStarted = true;
+    return 0;
+}
+
+void BoostScheduler::arm(int id, long long durationNs)
+{
+    struct itimerspec its;
+    Lease *l;
+
+    if (id < 0 || id >= mNumLeases)
+        return;
+    l = &mLeases[id];
+
+    memset(&its, 0, sizeof(its));
+    pthread_mutex_lock(&l->lock);
+    if (!l->active) {
+        l->active = true;
+        l->startTime = now_ns();
+        if (l->onStart)
+            l->onStart(l->arg);
+    }
+
+    if (durationNs > 0) {
+        l->expiry = now_ns() + durationNs;
+        its.it_value.tv_sec = l->expiry / NSEC_PER_SEC;
+        its.it_value.tv_nsec = l->expiry % NSEC_PER_SEC;
+    } else {
+        l->expiry = 0;
+    }
+    /* a zero it_value disarms the timer for open-ended leases */
+    timerfd_settime(l->timerFd, TFD_TIMER_ABSTIME, &its, NULL);
+    pthread_mutex_unlock(&l->lock);
+}
+
+void BoostScheduler::release(int id)
+{
+    struct itimerspec its;
+    Lease *l;
+
+    if (id < 0 || id >= mNumLeases)
+        return;
+    l = &mLeases[id];
+
+    memset(&its, 0, sizeof(its));
+    pthread_mutex_lock(&l->lock);
+    if (l->active) {
+        timerfd_settime(l->timerFd, TFD_TIMER_ABSTIME, &its, NULL);
+        end(l);
+    }
+    pthread_mutex_unlock(&l->lock);
+}
+
+bool BoostScheduler::isActive(int id)
+{
+    bool active;
+
+    if (id < 0 || id >= mNumLeases)
+        return false;
+
+    pthread_mutex_lock(&mLeases[id].lock);
+    active = mLeases[id].active;
+    pthread_mutex_unlock(&mLeases[id].lock);
+    return active;
+}
+
+/* called with the lease lock held */
+void BoostScheduler::end(Lease *l)
+{
+    l->active = false;
+    l->expiry = 0;
+    l->durations->record(now_ns() - l->startTime);
+    if (l->onExpire)
+        l->onExpire(l->arg);
+}
+
+void BoostScheduler::expire(Lease *l)
+{
+    uint64_t expirations;
+
+    /* drain the timerfd; EAGAIN means it was re-armed before we got here */
+    if (read(l->timerFd, &expirations, sizeof(expirations)) < 0)
+        return;
+
+    pthread_mutex_lock(&l->lock);
+    if (l->active && l->expiry && l->expiry <= now_ns())
+        end(l);
+    pthread_mutex_unlock(&l->lock);
+}
+
+void *BoostScheduler::threadLoop(void *arg)
+{
+    BoostScheduler *self = (BoostScheduler *)arg;
+    struct epoll_event events[BOOST_MAX_LEASES];
+    int n, i;
+
+    while (1) {
+        n = epoll_wait(self->mEpollFd, events, BOOST_MAX_LEASES, -1);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            ALOGE("Boost scheduler epoll_wait failed (%d)", errno);
+            break;
+        }
+        for (i = 0; i < n; i++)
+            self->expire(&self->mLeases[events[i].data.u32]);
+    }
+    return NULL;
+}
+
+void BoostScheduler::dump(int fd)
+{
+    int i;
+
+    dprintf(fd, "boost leases:\n");
+    for (i = 0; i < mNumLeases; i++) {
+        Lease *l = &mLeases[i];
+
+        pthread_mutex_lock(&l->lock);
+        if (l->active)
+            dprintf(fd, "  %s active for %lld ms\n", l->name,
+                    (now_ns() - l->startTime) / LATENCY_UNIT_MS);
+        pthread_mutex_unlock(&l->lock);
+        l->durations->dump(fd);
+    }
+}
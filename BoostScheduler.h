@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2014 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_BOOST_SCHEDULER_H
+#define ANDROID_BOOST_SCHEDULER_H
+
+#include <pthread.h>
+
+#include "LatencyHistogram.h"
+
+#define BOOST_MAX_LEASES 16
+
+typedef void (*lease_cb_t)(void *arg);
+
+/**
+ * Duration-based boosts as named leases. Each lease owns a timerfd that
+ * is watched by a single epoll loop; arming or extending a lease is one
+ * timerfd_settime() call and never wakes the loop.
+ *
+ * onStart runs when a lease goes from inactive to active, onExpire when it
+ * times out or is released. Both run with the lease lock held, so their
+ * actuations are always ordered the same way as the state changes.
+ */
+class BoostScheduler {
+
+  public:
+      BoostScheduler();
+      virtual ~BoostScheduler(){};
+      /* Leases must be registered before start() */
+      int addLease(const char *name, lease_cb_t onStart, lease_cb_t onExpire, void *arg);
+      int start();
+      /* durationNs == 0 keeps the lease until release() */
+      void arm(int id, long long durationNs);
+      void release(int id);
+      bool isActive(int id);
+      void dump(int fd);
+
+  private:
+      struct Lease {
+          const char *name;
+          int timerFd;
+          lease_cb_t onStart;
+          lease_cb_t onExpire;
+          void *arg;
+          pthread_mutex_t lock;
+          bool active;
+          /* absolute CLOCK_MONOTONIC expiry in ns, 0 if none */
+          long long expiry;
+          /* boost-on durations, recorded when the lease ends */
+          long long startTime;
+          LatencyHistogram *durations;
+      };
+
+      Lease mLeases[BOOST_MAX_LEASES];
+      int mNumLeases;
+      int mEpollFd;
+      bool mStarted;
+      pthread_t mThread;
+
+      void expire(Lease *l);
+      void end(Lease *l);
+      static void *threadLoop(void *arg);
+};
+#endif  // ANDROID_BOOST_SCHEDULER_H
@@ -0,0 +1,139 @@
+/*
+ * Copyright (C) 2014 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "PowerHAL"
+
+#include "CGroupBoostController.h"
+#include "PowerFs.h"
+
+#include <cutils/log.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+static const char* SCHEDTUNE_BOOST = "/dev/stune/foreground/schedtune.boost";
+static const char* UCLAMP_MIN[CGROUP_BOOST_MAX_GROUPS] = {
+    "/dev/cpuctl/top-app/cpu.uclamp.min",
+    "/dev/cpuctl/foreground/cpu.uclamp.min",
+};
+
+CGroupBoostController::CGroupBoostController():
+    mNumGroups(0),
+    mUclamp(false),
+    mArbiter(NULL)
+{
+    int g;
+
+    for (g = 0; g < CGROUP_BOOST_MAX_GROUPS; g++) {
+        mNodes[g] = NULL;
+        mKnobs[g] = -1;
+    }
+}
+
+CGroupBoostController::~CGroupBoostController()
+{
+    int g;
+
+    for (g = 0; g < mNumGroups; g++)
+        delete mNodes[g];
+}
+
+/* boost nodes are written at input rate, so they stay open */
+bool CGroupBoostController::addGroup(const char *path)
+{
+    SysfsNode *node;
+
+    if (PowerFs::get()->access(path, W_OK))
+        return false;
+    node = new SysfsNode(path);
+    if (node->open()) {
+        delete node;
+        return false;
+    }
+    mNodes[mNumGroups++] = node;
+    return true;
+}
+
+bool CGroupBoostController::probe()
+{
+    int g;
+
+    if (addGroup(SCHEDTUNE_BOOST)) {
+        ALOGI("Foreground boost through schedtune");
+        return true;
+    }
+    for (g = 0; g < CGROUP_BOOST_MAX_GROUPS; g++)
+        addGroup(UCLAMP_MIN[g]);
+    if (!mNumGroups) {
+        ALOGW("Neither schedtune nor uclamp available, no foreground boost");
+        return false;
+    }
+    mUclamp = true;
+    ALOGI("Foreground boost through uclamp.min of %d groups", mNumGroups);
+    return true;
+}
+
+const char *CGroupBoostController::name() const
+{
+    if (!mNumGroups)
+        return "none";
+    return mUclamp ? "uclamp" : "schedtune";
+}
+
+void CGroupBoostController::attach(SysfsActuator *actuator, BoostArbiter *arbiter)
+{
+    char buf[32];
+    int g, def;
+
+    mArbiter = arbiter;
+    for (g = 0; g < mNumGroups; g++) {
+        /* schedtune boots at 10, uclamp.min at "0.00"; both parse as integers */
+        def = PowerFs::get()->readFile(mNodes[g]->path(), buf, sizeof(buf)) ? 0 : atoi(buf);
+        mKnobs[g] = arbiter->addKnob(mNodes[g]->path(), actuator,
+                actuator->addNode(mNodes[g], false), BoostArbiter::AGGREGATE_MAX, def);
+    }
+}
+
+void CGroupBoostController::request(int requester, int level, long long durationNs)
+{
+    int g;
+
+    if (level <= 0) {
+        cancel(requester);
+        return;
+    }
+    /* re-requesting extends the expiry of the running boost */
+    for (g = 0; g < mNumGroups; g++)
+        mArbiter->request(mKnobs[g], requester, level, BoostArbiter::PRIORITY_NORMAL,
+                          durationNs);
+}
+
+void CGroupBoostController::cancel(int requester)
+{
+    int g;
+
+    for (g = 0; g < mNumGroups; g++)
+        mArbiter->cancel(mKnobs[g], requester);
+}
+
+void CGroupBoostController::dump(int fd)
+{
+    int g;
+
+    dprintf(fd, "cgroup boost: %s\n", name());
+    for (g = 0; g < mNumGroups; g++)
+        dprintf(fd, "  %s: %d\n", mNodes[g]->path(), mArbiter ? mArbiter->value(mKnobs[g]) : -1);
+}
@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 2014 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_CGROUP_BOOST_CONTROLLER_H
+#define ANDROID_CGROUP_BOOST_CONTROLLER_H
+
+#include "BoostArbiter.h"
+#include "SysfsActuator.h"
+#include "SysfsNode.h"
+
+#define CGROUP_BOOST_MAX_GROUPS 2
+
+/**
+ * Per-cgroup utilisation boost for the foreground tasks: schedtune.boost
+ * of the foreground stune group where the kernel still has schedtune,
+ * otherwise cpu.uclamp.min of the top-app and foreground cpu groups
+ * (kernels 5.4 and later).
+ *
+ * Every group is an arbiter knob, so boosts from several requesters
+ * aggregate to the highest level, expire through the arbiter timer and
+ * are only written when that level changes. Levels are percentages on
+ * both kernels; without requests each group returns to its boot value.
+ */
+class CGroupBoostController {
+
+  public:
+      CGroupBoostController();
+      virtual ~CGroupBoostController();
+      /* open the boost nodes; false if the kernel has neither */
+      bool probe();
+      bool active() const { return mNumGroups > 0; };
+      const char *name() const;
+      /* register the arbiter knobs; call before the actuator starts */
+      void attach(SysfsActuator *actuator, BoostArbiter *arbiter);
+      /* level 0 drops the request; durationNs 0 holds it until cancel() */
+      void request(int requester, int level, long long durationNs = 0);
+      void cancel(int requester);
+      void dump(int fd);
+
+  private:
+      SysfsNode *mNodes[CGROUP_BOOST_MAX_GROUPS];
+      int mKnobs[CGROUP_BOOST_MAX_GROUPS];
+      int mNumGroups;
+      bool mUclamp;
+      BoostArbiter *mArbiter;
+
+      bool addGroup(const char *path);
+};
+#endif  // ANDROID_CGROUP_BOOST_CONTROLLER_H
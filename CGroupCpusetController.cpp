@@ -18,6 +18,7 @@
 #define LOG_NDEBUG 0
 
 #include "CGroupCpusetController.h"
+#include "PowerFs.h"
 
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -28,107 +29,644 @@
 #include <cutils/log.h>
 #include <cutils/properties.h>
 #include <errno.h>
+#include <stdio.h>
 #include <string.h>
+#include <time.h>
+#include <unistd.h>
 
 static const char* CPUSET_ROOT_CPUS = "/dev/cpuset/cpus";
-static const char* CPUSET_NON_INTERACTIVE_CPUS = "/dev/cpuset/non_interactive/cpus";
 static const char* POWER_HAL_CPUSET_PROPERTY = "ro.powerhal.cpuset_config";
 static const char* POWER_HAL_CPUSET_PROPERTY_DEBUG = "persist.powerhal.cpuset_config"; /* for userdebug, eng build tuning*/
+static const char* POWER_HAL_VERIFY_WRITES_PROPERTY = "persist.powerhal.verify_writes"; /* for userdebug, eng build */
 
-CGroupCpusetController::CGroupCpusetController()
+/*
+ * Per profile override, "<foreground>;<background>;<top-app>;<non_interactive>"
+ * e.g. ro.powerhal.cpuset.low_power "0-3;0;0-3;0". Empty fields keep the default.
+ */
+static const char* POWER_HAL_CPUSET_PROFILE_PROPERTY = "ro.powerhal.cpuset.";
+static const char* POWER_HAL_CPUSET_PROFILE_PROPERTY_DEBUG = "persist.powerhal.cpuset."; /* for userdebug, eng build tuning*/
+
+static const char* CPUSET_GROUP_CPUS[CGroupCpusetController::NUM_GROUPS] = {
+    "/dev/cpuset/foreground/cpus",
+    "/dev/cpuset/background/cpus",
+    "/dev/cpuset/top-app/cpus",
+    "/dev/cpuset/non_interactive/cpus",
+};
+
+/* cgroup paths of the groups, and the schedtune group that goes with each */
+static const char* CPUSET_GROUP_PATHS[CGroupCpusetController::NUM_GROUPS] = {
+    "/foreground",
+    "/background",
+    "/top-app",
+    "/non_interactive",
+};
+static const char* STUNE_GROUP_PATHS[CGroupCpusetController::NUM_GROUPS] = {
+    "/foreground",
+    "/background",
+    "/top-app",
+    "/background",
+};
+static const char* CPUSET_MOUNT = "/dev/cpuset";
+static const char* STUNE_MOUNT = "/dev/stune";
+
+/* comma separated argv[0] of daemons confined to non_interactive at screen off */
+static const char* POWER_HAL_THROTTLE_PROPERTY = "ro.powerhal.throttle.procs";
+static const char* POWER_HAL_THROTTLE_PROPERTY_DEBUG = "persist.powerhal.throttle.procs"; /* for userdebug, eng build tuning*/
+
+static const char* CPUSET_PROFILE_NAMES[CGroupCpusetController::NUM_PROFILES] = {
+    "interactive",
+    "idle",
+    "sustained",
+    "launch",
+    "low_power",
+    "touch",
+};
+
+/* read a cpus list, dropping the trailing newline; 0 on success */
+static int read_cpus(const char *path, char *cpus, size_t size)
+{
+    if (PowerFs::get()->readFile(path, cpus, size)) {
+        ALOGV("Could not read the file: %s (%d)", path, errno);
+        return -1;
+    }
+    return 0;
+}
+
+/* whole multi-line file, NUL terminated; 0 on success */
+static int read_lines(const char *path, char *buf, size_t size)
 {
+    ssize_t ret;
     int fd;
-    int ret;
-    int len;
+
+    fd = PowerFs::get()->open(path, O_RDONLY);
+    if (fd < 0)
+        return -1;
+    ret = PowerFs::get()->pread(fd, buf, size - 1, 0);
+    PowerFs::get()->close(fd);
+    if (ret <= 0)
+        return -1;
+    buf[ret] = '\0';
+    return 0;
+}
+
+/* start time in clock ticks since boot, field 22 of /proc/<pid>/stat; 0 if gone */
+static unsigned long long proc_start_time(pid_t pid)
+{
+    char path[32];
+    char stat[512];
+    char *p;
+    int field;
+
+    snprintf(path, sizeof(path), "/proc/%d/stat", pid);
+    if (read_lines(path, stat, sizeof(stat)))
+        return 0;
+    /* comm may hold spaces and parentheses; the fields resume after the last ')' */
+    p = strrchr(stat, ')');
+    if (!p)
+        return 0;
+    for (field = 2; field < 22 && p; field++)
+        p = strchr(p + 1, ' ');
+    return p ? strtoull(p + 1, NULL, 10) : 0;
+}
+
+/* split "a;b" into root and non-interactive cpus */
+static bool parse_legacy_config(const char *prop, char *root, char *nonint)
+{
     char cpuset_config[PROPERTY_VALUE_MAX];
+    char *conf;
+    char *next_token;
+    int len;
+
+    len = property_get(prop, cpuset_config, NULL);
+    if (len <= 0)
+        return false;
+
+    cpuset_config[len] = '\0';
+    conf = strtok_r(cpuset_config, ";", &next_token);
+    if (conf)
+        snprintf(root, CPUSET_CPUS_MAX, "%s", conf);
+    conf = strtok_r(NULL, ";", &next_token);
+    if (conf)
+        snprintf(nonint, CPUSET_CPUS_MAX, "%s", conf);
+    return true;
+}
+
+CGroupCpusetController::CGroupCpusetController():
+    mActuator(NULL),
+    mInteractive(true),
+    mProfile(-1),
+    mVerifyWrites(false),
+    mSwitchHist("cpuset_switch"),
+    mNumPlacements(0),
+    mPlaceMoves(0),
+    mPlaceSkips(0),
+    mThrottleStarted(false),
+    mThrottleWanted(false),
+    mThrottled(false)
+{
+    int i;
+
+    pthread_mutex_init(&mLock, NULL);
+    pthread_mutex_init(&mPlaceLock, NULL);
+    pthread_cond_init(&mThrottleCond, NULL);
+    memset(mRequests, 0, sizeof(mRequests));
+    memset(mSwitches, 0, sizeof(mSwitches));
+    memset(mApplied, 0, sizeof(mApplied));
+    /* empty profiles and baselines until probe(): every switch is a no-op */
+    memset(mProfiles, 0, sizeof(mProfiles));
+    memset(mBaseline, 0, sizeof(mBaseline));
+    for (i = 0; i < NUM_GROUPS; i++) {
+        mGroupNodes[i] = new SysfsNode(CPUSET_GROUP_CPUS[i], O_RDWR);
+        mActuatorIds[i] = -1;
+    }
+}
+
+void CGroupCpusetController::probe()
+{
+    int i;
+
+    pthread_mutex_lock(&mLock);
+    mTopology.probe();
+    for (i = 0; i < NUM_GROUPS; i++)
+        if (read_cpus(CPUSET_GROUP_CPUS[i], mBaseline[i], sizeof(mBaseline[i])))
+            mBaseline[i][0] = '\0';
 
 #ifdef POWERHAL_DEBUG
-    len = property_get(POWER_HAL_CPUSET_PROPERTY_DEBUG, cpuset_config, NULL);
-    if (len > 0) {
-        cpuset_config[len] = '\0';
-        char *conf;
-        char *next_token;
-        conf = strtok_r(cpuset_config, ";", &next_token);
-        if (conf)
-            snprintf(mCpusetRootCpus, strlen(conf)+1, "%s", conf);
-        conf = strtok_r(NULL, ";", &next_token);
-        if (conf)
-            snprintf(mCpusetNoninterCpus, strlen(conf)+1, "%s", conf);
-        return;
+    mVerifyWrites = property_get_bool(POWER_HAL_VERIFY_WRITES_PROPERTY, false);
+#endif
+    loadLegacyConfig();
+    loadProfiles();
+    pthread_mutex_unlock(&mLock);
+
+    pthread_mutex_lock(&mPlaceLock);
+    loadThrottleNames();
+    if (!mThrottleNames.empty() && !mThrottleStarted) {
+        mThrottleStarted = !pthread_create(&mThrottleThread, NULL, throttleLoop, this);
+        if (!mThrottleStarted)
+            ALOGW("Could not start the throttle thread, throttling inline");
     }
+    pthread_mutex_unlock(&mPlaceLock);
+}
+
+CGroupCpusetController::~CGroupCpusetController()
+{
+    int i;
+
+    for (i = 0; i < NUM_GROUPS; i++)
+        delete mGroupNodes[i];
+    for (i = 0; i < (int)mProcsNodes.size(); i++)
+        delete mProcsNodes[i];
+}
+
+void CGroupCpusetController::loadLegacyConfig()
+{
+    /* Default to set .cpus to 0 */
+    snprintf(mCpusetRootCpus, sizeof(mCpusetRootCpus), "0");
+    snprintf(mCpusetNoninterCpus, sizeof(mCpusetNoninterCpus), "0");
+
+#ifdef POWERHAL_DEBUG
+    if (parse_legacy_config(POWER_HAL_CPUSET_PROPERTY_DEBUG, mCpusetRootCpus, mCpusetNoninterCpus))
+        return;
 #endif
-    len = property_get(POWER_HAL_CPUSET_PROPERTY, cpuset_config, NULL);
-    if (len > 0) {
-        cpuset_config[len] = '\0';
-        char *conf;
-        char *next_token;
-        conf = strtok_r(cpuset_config, ";", &next_token);
-        if (conf)
-            snprintf(mCpusetRootCpus, strlen(conf)+1, "%s", conf);
-        conf = strtok_r(NULL, ";", &next_token);
-        if (conf)
-            snprintf(mCpusetNoninterCpus, strlen(conf)+1, "%s", conf);
-    } else {
-        /* Default to set .cpus to 0 */
+    if (parse_legacy_config(POWER_HAL_CPUSET_PROPERTY, mCpusetRootCpus, mCpusetNoninterCpus))
+        return;
+
+    /**
+     * Read the default cpuset .cpus number.
+     * Will be used when device is interactive.
+     * Not a hard error; default is "0" (CPU core #0 only).
+     */
+    if (read_cpus(CPUSET_ROOT_CPUS, mCpusetRootCpus, sizeof(mCpusetRootCpus)))
         snprintf(mCpusetRootCpus, sizeof(mCpusetRootCpus), "0");
 
-        /**
-         * Read the default cpuset .cpus number.
-         * Will be used when device is interactive.
+    /* On hybrid parts keep screen-off work on the E-cores only */
+    if (mTopology.isHybrid())
+        snprintf(mCpusetNoninterCpus, sizeof(mCpusetNoninterCpus), "%s",
+                 mTopology.efficiencyCpus());
+}
+
+void CGroupCpusetController::loadProfiles()
+{
+    /* profile property names are longer than the legacy PROPERTY_KEY_MAX */
+    char prop[PROPERTY_VALUE_MAX];
+    char value[PROPERTY_VALUE_MAX];
+    char *cursor;
+    char *field;
+    int p, g;
+
+    /*
+     * Defaults keep the historical behaviour of only driving
+     * non_interactive, plus: launch opens foreground/top-app to every
+     * core, and low power packs background work onto the
+     * non-interactive cpus.
+     */
+    memset(mProfiles, 0, sizeof(mProfiles));
+    for (p = 0; p < NUM_PROFILES; p++) {
+        bool restricted = p == PROFILE_IDLE || p == PROFILE_LOW_POWER;
+        snprintf(mProfiles[p][GROUP_NON_INTERACTIVE], CPUSET_CPUS_MAX, "%s",
+                 restricted ? mCpusetNoninterCpus : mCpusetRootCpus);
+    }
+    snprintf(mProfiles[PROFILE_LAUNCH][GROUP_FOREGROUND], CPUSET_CPUS_MAX, "%s", mCpusetRootCpus);
+    snprintf(mProfiles[PROFILE_LAUNCH][GROUP_TOP_APP], CPUSET_CPUS_MAX, "%s", mCpusetRootCpus);
+    snprintf(mProfiles[PROFILE_LOW_POWER][GROUP_BACKGROUND], CPUSET_CPUS_MAX, "%s", mCpusetNoninterCpus);
+    /* pin the touched app to the P-cores; a no-op on non-hybrid parts */
+    if (mTopology.isHybrid())
+        snprintf(mProfiles[PROFILE_TOUCH][GROUP_TOP_APP], CPUSET_CPUS_MAX, "%s",
+                 mTopology.performanceCpus());
+
+    for (p = 0; p < NUM_PROFILES; p++) {
+        int len = 0;
+
+#ifdef POWERHAL_DEBUG
+        snprintf(prop, sizeof(prop), "%s%s", POWER_HAL_CPUSET_PROFILE_PROPERTY_DEBUG, CPUSET_PROFILE_NAMES[p]);
+        len = property_get(prop, value, NULL);
+#endif
+        if (len <= 0) {
+            snprintf(prop, sizeof(prop), "%s%s", POWER_HAL_CPUSET_PROFILE_PROPERTY, CPUSET_PROFILE_NAMES[p]);
+            len = property_get(prop, value, NULL);
+        }
+        if (len <= 0)
+            continue;
+
+        /* strsep keeps empty fields, so ";;0" only overrides non_interactive */
+        cursor = value;
+        for (g = 0; g < NUM_GROUPS && (field = strsep(&cursor, ";")); g++) {
+            if (*field)
+                snprintf(mProfiles[p][g], CPUSET_CPUS_MAX, "%s", field);
+        }
+    }
+}
+
+void CGroupCpusetController::loadThrottleNames()
+{
+    char value[PROPERTY_VALUE_MAX];
+    char *name, *save;
+    int len = 0;
+
+#ifdef POWERHAL_DEBUG
+    len = property_get(POWER_HAL_THROTTLE_PROPERTY_DEBUG, value, NULL);
+#endif
+    if (len <= 0)
+        len = property_get(POWER_HAL_THROTTLE_PROPERTY, value, NULL);
+    if (len <= 0)
+        return;
+
+    for (name = strtok_r(value, ",", &save); name; name = strtok_r(NULL, ",", &save))
+        mThrottleNames.push_back(name);
+}
+
+int CGroupCpusetController::selectProfile()
+{
+    if (!mInteractive)
+        return PROFILE_IDLE;
+    if (mRequests[PROFILE_LAUNCH])
+        return PROFILE_LAUNCH;
+    if (mRequests[PROFILE_TOUCH])
+        return PROFILE_TOUCH;
+    if (mRequests[PROFILE_SUSTAINED])
+        return PROFILE_SUSTAINED;
+    if (mRequests[PROFILE_LOW_POWER])
+        return PROFILE_LOW_POWER;
+    return PROFILE_INTERACTIVE;
+}
+
+bool CGroupCpusetController::cpusMatch(int group, const char *cpus)
+{
+    char current[CPUSET_CPUS_MAX];
+    int len;
+
+    len = mGroupNodes[group]->read(current, sizeof(current) - 1);
+    if (len <= 0)
+        return false;
+    current[len] = '\0';
+    current[strcspn(current, "\n")] = '\0';
+    return !strcmp(current, cpus);
+}
+
+void CGroupCpusetController::applyProfile(int profile)
+{
+    struct timespec start, end;
+    int g;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (g = 0; g < NUM_GROUPS; g++) {
+        const char *cpus = mProfiles[profile][g][0] ? mProfiles[profile][g] : mBaseline[g];
+
+        if (!cpus[0])
+            continue;
+
+        /* repeated transitions to the same profile are no-ops */
+        if (mApplied[g] && !strcmp(cpus, mApplied[g])) {
+            if (!mVerifyWrites || cpusMatch(g, cpus))
+                continue;
+            ALOGW("Cached cpuset state of %s is stale, rewriting %s", CPUSET_GROUP_CPUS[g], cpus);
+        }
+
+        /*
+         * Only a write that has landed is cached. A post may still fail
+         * on the actuator thread, so leave it unknown and let the
+         * actuator skip the repeats it has already applied.
          */
-        fd = open(CPUSET_ROOT_CPUS, O_RDONLY);
+        if (writeGroup(g, cpus)) {
+            mApplied[g] = NULL;
+            continue;
+        }
+        mApplied[g] = cpus;
+
+        if (mVerifyWrites && !cpusMatch(g, cpus))
+            ALOGW("Read-back of %s does not match %s", CPUSET_GROUP_CPUS[g], cpus);
+    }
+
+    if (profile != mProfile) {
+        ALOGV("cpuset profile %s", CPUSET_PROFILE_NAMES[profile]);
+        mSwitches[profile]++;
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        mSwitchHist.record((end.tv_sec - start.tv_sec) * 1000000000LL +
+                           (end.tv_nsec - start.tv_nsec));
+    }
+    mProfile = profile;
+}
+
+void CGroupCpusetController::attachActuator(SysfsActuator *actuator)
+{
+    int g;
+
+    pthread_mutex_lock(&mLock);
+    mActuator = actuator;
+    for (g = 0; g < NUM_GROUPS; g++)
+        mActuatorIds[g] = actuator->addNode(mGroupNodes[g], false);
+    pthread_mutex_unlock(&mLock);
+}
+
+/* 0 once the cpus have landed, 1 if posted to the actuator, -1 on error */
+int CGroupCpusetController::writeGroup(int group, const char *cpus)
+{
+    /*
+     * Hint-driven switches must not block the caller on cgroupfs, so
+     * post to the actuator when there is one. Read-back verification
+     * needs the write to have landed, so it stays synchronous.
+     */
+    if (mActuator && mActuatorIds[group] >= 0 && !mVerifyWrites)
+        return mActuator->post(mActuatorIds[group], cpus) ? 1 : -1;
+    return mGroupNodes[group]->write(cpus) ? -1 : 0;
+}
+
+/* TGIDs whose argv[0] is one of names; one pass over /proc */
+int CGroupCpusetController::findProcesses(const std::vector<std::string> &names,
+                                          pid_t *pids, int max)
+{
+    std::vector<std::string> entries;
+    char path[32];
+    char cmdline[128];
+    size_t i, n;
+    int count = 0;
+
+    if (PowerFs::get()->listDir("/proc", &entries))
+        return 0;
+
+    for (i = 0; i < entries.size() && count < max; i++) {
+        if (!isdigit(entries[i][0]))
+            continue;
+        snprintf(path, sizeof(path), "/proc/%s/cmdline", entries[i].c_str());
+        /* cmdline is NUL separated, so the buffer reads as argv[0] */
+        if (PowerFs::get()->readFile(path, cmdline, sizeof(cmdline)))
+            continue;
+        for (n = 0; n < names.size(); n++)
+            if (names[n] == cmdline) {
+                pids[count++] = atoi(entries[i].c_str());
+                break;
+            }
+    }
+    return count;
+}
+
+/* called with mPlaceLock held */
+int CGroupCpusetController::moveProcess(const char *hierarchy, const char *path, pid_t pid)
+{
+    char procs[96];
+    char value[12];
+    SysfsNode *node = NULL;
+    size_t i;
 
-        if (fd < 0) {
-            /* not a hard error; default is "0" (CPU core #0 only). */
-            ALOGV("Could not open the file: %s (%d)", CPUSET_ROOT_CPUS, errno);
-            return;
+    if (!strcmp(path, "/"))
+        path = "";
+    snprintf(procs, sizeof(procs), "%s%s/cgroup.procs", hierarchy, path);
+    for (i = 0; i < mProcsNodes.size(); i++)
+        if (!strcmp(mProcsNodes[i]->path(), procs)) {
+            node = mProcsNodes[i];
+            break;
         }
+    if (!node) {
+        node = new SysfsNode(procs);
+        mProcsNodes.push_back(node);
+    }
+
+    /* cgroup.procs takes a single TGID per write */
+    snprintf(value, sizeof(value), "%d", pid);
+    return node->write(value);
+}
+
+int CGroupCpusetController::placeProcesses(const pid_t *pids, int count, int group)
+{
+    char path[32];
+    char cgroups[1024];
+    char *line, *save;
+    int i, p, moved = 0;
 
-        ret = read(fd, mCpusetRootCpus, sizeof(mCpusetRootCpus));
-        if (ret <= 0) {
-            /* nothing is being read but not a hard error */
-            /* default is "0" (CPU core #0 only).         */
-            ALOGV("Error when reading from file (%d)", errno);
-            close(fd);
-            return;
+    if (group < 0 || group >= NUM_GROUPS)
+        return 0;
+
+    pthread_mutex_lock(&mPlaceLock);
+    for (i = 0; i < count; i++) {
+        Placement *pl = NULL;
+
+        for (p = 0; p < mNumPlacements; p++)
+            if (mPlacements[p].pid == pids[i])
+                break;
+        if (p < mNumPlacements) {
+            pl = &mPlacements[p];
+            if (pl->group == group) {
+                mPlaceSkips++;
+                continue;
+            }
+        } else {
+            if (mNumPlacements >= CGROUP_PLACEMENTS_MAX)
+                break;
+            pl = &mPlacements[mNumPlacements];
+            memset(pl, 0, sizeof(*pl));
+            pl->startTime = proc_start_time(pids[i]);
+            if (!pl->startTime)
+                continue;
+
+            /* remember where the process came from, e.g. "4:cpuset:/foreground" */
+            snprintf(path, sizeof(path), "/proc/%d/cgroup", pids[i]);
+            if (read_lines(path, cgroups, sizeof(cgroups)))
+                continue;
+            for (line = strtok_r(cgroups, "\n", &save); line; line = strtok_r(NULL, "\n", &save)) {
+                char *controller = strchr(line, ':');
+                char *cgroup = controller ? strchr(controller + 1, ':') : NULL;
+
+                if (!cgroup)
+                    continue;
+                *cgroup++ = '\0';
+                controller++;
+                if (!strcmp(controller, "cpuset"))
+                    snprintf(pl->cpuset, sizeof(pl->cpuset), "%s", cgroup);
+                else if (!strcmp(controller, "schedtune"))
+                    snprintf(pl->stune, sizeof(pl->stune), "%s", cgroup);
+            }
+            if (!pl->cpuset[0])
+                continue;
+            if (!strcmp(pl->cpuset, CPUSET_GROUP_PATHS[group])) {
+                /* already there on its own; nothing to undo later either */
+                mPlaceSkips++;
+                continue;
+            }
+            pl->pid = pids[i];
+            mNumPlacements++;
         }
 
-        mCpusetRootCpus[sizeof(mCpusetRootCpus) - 1] = '\0';
-        close(fd);
-        mCpusetNoninterCpus[0] = '0';
-        mCpusetNoninterCpus[1] = '\0';
+        pl->group = group;
+        if (moveProcess(CPUSET_MOUNT, CPUSET_GROUP_PATHS[group], pl->pid))
+            continue;
+        if (pl->stune[0])
+            moveProcess(STUNE_MOUNT, STUNE_GROUP_PATHS[group], pl->pid);
+        mPlaceMoves++;
+        moved++;
     }
-    return;
+    pthread_mutex_unlock(&mPlaceLock);
+    return moved;
 }
 
-void CGroupCpusetController::setState(int state)
+void CGroupCpusetController::restoreProcesses()
 {
-    int fd;
-    int ret = 0;
+    int p;
+
+    pthread_mutex_lock(&mPlaceLock);
+    for (p = 0; p < mNumPlacements; p++) {
+        Placement *pl = &mPlacements[p];
+
+        /* the process exited and its PID may belong to someone else now */
+        if (proc_start_time(pl->pid) != pl->startTime) {
+            ALOGV("Placed process %d is gone, not restoring it", pl->pid);
+            continue;
+        }
+        moveProcess(CPUSET_MOUNT, pl->cpuset, pl->pid);
+        if (pl->stune[0])
+            moveProcess(STUNE_MOUNT, pl->stune, pl->pid);
+    }
+    mNumPlacements = 0;
+    pthread_mutex_unlock(&mPlaceLock);
+}
+
+void CGroupCpusetController::throttleProcesses(bool throttle)
+{
+    pid_t pids[CGROUP_PLACEMENTS_MAX];
+    int count;
+
+    if (mThrottleNames.empty())
+        return;
+    if (!throttle) {
+        restoreProcesses();
+        return;
+    }
+    count = findProcesses(mThrottleNames, pids, CGROUP_PLACEMENTS_MAX);
+    count = placeProcesses(pids, count, GROUP_NON_INTERACTIVE);
+    ALOGV("Confined %d background processes", count);
+}
+
+void *CGroupCpusetController::throttleLoop(void *arg)
+{
+    CGroupCpusetController *self = (CGroupCpusetController *)arg;
+    bool throttle;
 
+    pthread_mutex_lock(&self->mPlaceLock);
+    while (1) {
+        while (self->mThrottled == self->mThrottleWanted)
+            pthread_cond_wait(&self->mThrottleCond, &self->mPlaceLock);
+        /* a flip while the walk runs is picked up on the next pass */
+        throttle = self->mThrottleWanted;
+        self->mThrottled = throttle;
+        pthread_mutex_unlock(&self->mPlaceLock);
+        self->throttleProcesses(throttle);
+        pthread_mutex_lock(&self->mPlaceLock);
+    }
+    return NULL;
+}
+
+void CGroupCpusetController::requestThrottle(bool throttle)
+{
+    pthread_mutex_lock(&mPlaceLock);
+    if (mThrottleStarted) {
+        mThrottleWanted = throttle;
+        pthread_cond_signal(&mThrottleCond);
+        pthread_mutex_unlock(&mPlaceLock);
+        return;
+    }
+    pthread_mutex_unlock(&mPlaceLock);
+    throttleProcesses(throttle);
+}
+
+void CGroupCpusetController::setState(int state)
+{
     /**
      * Enable all cpus if interactive
      * Restrict to certrain CPUs if non-interactive.
      */
-    fd = open(CPUSET_NON_INTERACTIVE_CPUS, O_WRONLY);
+    pthread_mutex_lock(&mLock);
+    mInteractive = state != 0;
+    applyProfile(selectProfile());
+    pthread_mutex_unlock(&mLock);
 
-    if (fd < 0) {
-        ALOGE("Could not open the file: %s (%d)", CPUSET_NON_INTERACTIVE_CPUS, errno);
+    /* heavy daemons follow the restricted non_interactive cpus while screen off */
+    requestThrottle(state == 0);
+}
+
+void CGroupCpusetController::requestProfile(int profile, bool active)
+{
+    if (profile < 0 || profile >= NUM_PROFILES)
         return;
-    }
 
-    if (state) {
-        /* Let loose when interactive */
-        ret = write(fd, mCpusetRootCpus, sizeof(mCpusetRootCpus));
-    }
-    else {
-        /* Restrict when non-interactive */
-        ret = write(fd, mCpusetNoninterCpus, sizeof(mCpusetNoninterCpus));
-    }
+    pthread_mutex_lock(&mLock);
+    mRequests[profile] = active;
+    applyProfile(selectProfile());
+    pthread_mutex_unlock(&mLock);
+}
 
-    if (ret < 0) {
-        ALOGE("Error when writing to the file (%d)", errno);
-    }
+int CGroupCpusetController::profile()
+{
+    int profile;
+
+    pthread_mutex_lock(&mLock);
+    profile = mProfile;
+    pthread_mutex_unlock(&mLock);
+    return profile;
+}
+
+void CGroupCpusetController::dump(int fd)
+{
+    int p, g;
+
+    pthread_mutex_lock(&mLock);
+    dprintf(fd, "cpuset: profile=%s hybrid=%d P=%s E=%s\n",
+            mProfile >= 0 ? CPUSET_PROFILE_NAMES[mProfile] : "none",
+            mTopology.isHybrid(), mTopology.performanceCpus(), mTopology.efficiencyCpus());
+    for (p = 0; p < NUM_PROFILES; p++)
+        dprintf(fd, "  %s: switches=%u requested=%d\n", CPUSET_PROFILE_NAMES[p],
+                mSwitches[p], mRequests[p]);
+    for (g = 0; g < NUM_GROUPS; g++)
+        dprintf(fd, "  %s = %s (writes=%u errors=%u)\n", CPUSET_GROUP_CPUS[g],
+                mApplied[g] ? mApplied[g] : "",
+                mGroupNodes[g]->writes(), mGroupNodes[g]->writeErrors());
+    pthread_mutex_unlock(&mLock);
+    mSwitchHist.dump(fd);
 
-    close(fd);
+    pthread_mutex_lock(&mPlaceLock);
+    dprintf(fd, "  placements: placed=%d moves=%u skipped=%u throttle_procs=%zu\n",
+            mNumPlacements, mPlaceMoves, mPlaceSkips, mThrottleNames.size());
+    for (p = 0; p < mNumPlacements; p++)
+        dprintf(fd, "    %d: %s, found in %s %s\n", mPlacements[p].pid,
+                CPUSET_GROUP_PATHS[mPlacements[p].group], mPlacements[p].cpuset,
+                mPlacements[p].stune);
+    pthread_mutex_unlock(&mPlaceLock);
 }
@@ -24,18 +24,137 @@
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <stdint.h>
+#include <pthread.h>
 #include <vector>
 
+#include "CpuTopology.h"
+#include "LatencyHistogram.h"
+#include "SysfsActuator.h"
+#include "SysfsNode.h"
+
+/* room for masks such as "0-3,8-11,16-19" */
+#define CPUSET_CPUS_MAX 64
+/* processes placed by the controller at any one time */
+#define CGROUP_PLACEMENTS_MAX 64
+/* cgroup path of a process relative to its hierarchy root */
+#define CGROUP_PATH_MAX 48
+
+/**
+ * Drives the cpus of several cpuset groups from named profiles. The
+ * effective profile follows the interactive state plus any profile
+ * requested through power hints; a switch rewrites every group that
+ * differs from what is currently applied, under one lock.
+ *
+ * Processes can also be placed into a group's cpuset and the matching
+ * schedtune group. Placements remember where each process was found, so
+ * restoreProcesses() undoes them; the daemons listed in
+ * ro.powerhal.throttle.procs are placed into non_interactive at screen
+ * off and restored at screen on. A throttle thread does that /proc walk,
+ * so setState() never waits for it.
+ */
 class CGroupCpusetController {
 
   public:
+      enum {
+          PROFILE_INTERACTIVE = 0,
+          PROFILE_IDLE,        /* screen off */
+          PROFILE_SUSTAINED,
+          PROFILE_LAUNCH,
+          PROFILE_LOW_POWER,
+          PROFILE_TOUCH,       /* interactive with top-app on the P-cores */
+          NUM_PROFILES
+      };
+      enum {
+          GROUP_FOREGROUND = 0,
+          GROUP_BACKGROUND,
+          GROUP_TOP_APP,
+          GROUP_NON_INTERACTIVE,
+          NUM_GROUPS
+      };
+
+      /* does no I/O, so a static instance costs nothing at library load */
       CGroupCpusetController();
-      virtual ~CGroupCpusetController() {};
+      virtual ~CGroupCpusetController();
+      /* read the topology, boot-time cpus and profile config; once, before use */
+      void probe();
       void setState(int state);
+      /* hint-driven profiles; screen-off always wins */
+      void requestProfile(int profile, bool active);
+      int profile();
+      /* route group writes through the actuator; call before it starts */
+      void attachActuator(SysfsActuator *actuator);
+      const CpuTopology &topology() const { return mTopology; };
+      /*
+       * Move TGIDs into a group; processes already placed there are
+       * skipped. Returns the number of processes moved.
+       */
+      int placeProcesses(const pid_t *pids, int count, int group);
+      /* put every placed process back where it was found */
+      void restoreProcesses();
+      void dump(int fd);
 
   private:
       /* "all" cpus string in root cpuset */
-      char mCpusetRootCpus[10];
-      char mCpusetNoninterCpus[10];
+      char mCpusetRootCpus[CPUSET_CPUS_MAX];
+      char mCpusetNoninterCpus[CPUSET_CPUS_MAX];
+      /* cpus per profile and group; an empty string means the boot-time value */
+      char mProfiles[NUM_PROFILES][NUM_GROUPS][CPUSET_CPUS_MAX];
+      char mBaseline[NUM_GROUPS][CPUSET_CPUS_MAX];
+      /*
+       * Last cpus successfully written per group, NULL if unknown. Points
+       * into mProfiles/mBaseline, which are built once, so a transition
+       * writes a prebuilt payload and never formats a copy.
+       */
+      const char *mApplied[NUM_GROUPS];
+      /* kept open across transitions */
+      SysfsNode *mGroupNodes[NUM_GROUPS];
+      SysfsActuator *mActuator;
+      int mActuatorIds[NUM_GROUPS];
+      CpuTopology mTopology;
+      bool mInteractive;
+      bool mRequests[NUM_PROFILES];
+      int mProfile;
+      pthread_mutex_t mLock;
+      /* debug: read the cpus back instead of trusting mApplied */
+      bool mVerifyWrites;
+      unsigned int mSwitches[NUM_PROFILES];
+      LatencyHistogram mSwitchHist;
+
+      struct Placement {
+          pid_t pid;
+          /* /proc/<pid>/stat start time, so a reused PID is never moved back */
+          unsigned long long startTime;
+          int group;
+          char cpuset[CGROUP_PATH_MAX];
+          char stune[CGROUP_PATH_MAX];
+      };
+      /* placement state has its own lock so hints never wait on a /proc walk */
+      pthread_mutex_t mPlaceLock;
+      Placement mPlacements[CGROUP_PLACEMENTS_MAX];
+      int mNumPlacements;
+      /* cgroup.procs nodes by path, opened on first use */
+      std::vector<SysfsNode *> mProcsNodes;
+      std::vector<std::string> mThrottleNames;
+      unsigned int mPlaceMoves;
+      unsigned int mPlaceSkips;
+      /* screen-off throttling, applied by mThrottleThread; under mPlaceLock */
+      pthread_t mThrottleThread;
+      pthread_cond_t mThrottleCond;
+      bool mThrottleStarted;
+      bool mThrottleWanted;
+      bool mThrottled;
+
+      void loadLegacyConfig();
+      void loadProfiles();
+      int selectProfile();
+      void applyProfile(int profile);
+      bool cpusMatch(int group, const char *cpus);
+      int writeGroup(int group, const char *cpus);
+      void loadThrottleNames();
+      int findProcesses(const std::vector<std::string> &names, pid_t *pids, int max);
+      int moveProcess(const char *hierarchy, const char *path, pid_t pid);
+      void throttleProcesses(bool throttle);
+      void requestThrottle(bool throttle);
+      static void *throttleLoop(void *arg);
 };
 #endif  // ANDROID_CGROUP_CPUSET_CONTROLLER_H
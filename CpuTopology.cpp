@@ -0,0 +1,207 @@
+/*
+ * Copyright (C) 2014 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "PowerHAL"
+
+#include "CpuTopology.h"
+#include "PowerFs.h"
+
+#include <cutils/log.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static const char* CPU_ONLINE = "/sys/devices/system/cpu/online";
+static const char* PMU_CORE_CPUS = "/sys/devices/cpu_core/cpus";
+static const char* PMU_ATOM_CPUS = "/sys/devices/cpu_atom/cpus";
+static const char* CPU_CAPACITY = "/sys/devices/system/cpu/cpu%d/cpu_capacity";
+static const char* CPU_THREAD_SIBLINGS = "/sys/devices/system/cpu/cpu%d/topology/thread_siblings_list";
+static const char* CPU_L2_SHARED = "/sys/devices/system/cpu/cpu%d/cache/index2/shared_cpu_list";
+
+static int read_line(const char *path, char *buf, size_t size)
+{
+    return PowerFs::get()->readFile(path, buf, size);
+}
+
+static int read_cpu_list(const char *path, cpu_mask_t *mask)
+{
+    char buf[256];
+
+    if (read_line(path, buf, sizeof(buf)))
+        return -1;
+    return CpuTopology::parseCpuList(buf, mask);
+}
+
+CpuTopology::CpuTopology():
+    mHybrid(false)
+{
+    mPerformanceList[0] = '\0';
+    mEfficiencyList[0] = '\0';
+}
+
+int CpuTopology::parseCpuList(const char *list, cpu_mask_t *mask)
+{
+    const char *p = list;
+    char *end;
+    long first, last;
+
+    mask->reset();
+    while (*p) {
+        first = strtol(p, &end, 10);
+        if (end == p || first < 0)
+            return -1;
+        last = first;
+        p = end;
+        if (*p == '-') {
+            last = strtol(p + 1, &end, 10);
+            if (end == p + 1 || last < first)
+                return -1;
+            p = end;
+        }
+        for (long cpu = first; cpu <= last && cpu < CPU_TOPOLOGY_MAX_CPUS; cpu++)
+            mask->set(cpu);
+        if (*p == ',')
+            p++;
+        else if (*p)
+            return -1;
+    }
+    return 0;
+}
+
+void CpuTopology::formatCpuList(const cpu_mask_t &mask, char *list, size_t size)
+{
+    size_t len = 0;
+    int cpu = 0;
+    int last;
+
+    list[0] = '\0';
+    while (cpu < CPU_TOPOLOGY_MAX_CPUS && len < size) {
+        if (!mask.test(cpu)) {
+            cpu++;
+            continue;
+        }
+        last = cpu;
+        while (last + 1 < CPU_TOPOLOGY_MAX_CPUS && mask.test(last + 1))
+            last++;
+        if (last == cpu)
+            len += snprintf(list + len, size - len, "%s%d", len ? "," : "", cpu);
+        else
+            len += snprintf(list + len, size - len, "%s%d-%d", len ? "," : "", cpu, last);
+        cpu = last + 1;
+    }
+}
+
+bool CpuTopology::probePmu()
+{
+    cpu_mask_t core, atom;
+
+    /* hybrid Intel parts expose one PMU per core type */
+    if (read_cpu_list(PMU_CORE_CPUS, &core) || read_cpu_list(PMU_ATOM_CPUS, &atom))
+        return false;
+
+    mPerformance = core & mOnline;
+    mEfficiency = atom & mOnline;
+    return mPerformance.any() && mEfficiency.any();
+}
+
+bool CpuTopology::probeCapacity()
+{
+    char path[PATH_MAX];
+    char buf[16];
+    int capacity[CPU_TOPOLOGY_MAX_CPUS];
+    int maxCapacity = 0;
+    int cpu;
+
+    for (cpu = 0; cpu < CPU_TOPOLOGY_MAX_CPUS; cpu++) {
+        if (!mOnline.test(cpu))
+            continue;
+        snprintf(path, sizeof(path), CPU_CAPACITY, cpu);
+        if (read_line(path, buf, sizeof(buf)))
+            return false;
+        capacity[cpu] = atoi(buf);
+        if (capacity[cpu] > maxCapacity)
+            maxCapacity = capacity[cpu];
+    }
+
+    mPerformance.reset();
+    mEfficiency.reset();
+    for (cpu = 0; cpu < CPU_TOPOLOGY_MAX_CPUS; cpu++) {
+        if (!mOnline.test(cpu))
+            continue;
+        if (capacity[cpu] == maxCapacity)
+            mPerformance.set(cpu);
+        else
+            mEfficiency.set(cpu);
+    }
+    return mEfficiency.any();
+}
+
+bool CpuTopology::probeCacheDomains()
+{
+    char path[PATH_MAX];
+    cpu_mask_t siblings, l2;
+    int cpu;
+
+    mPerformance.reset();
+    mEfficiency.reset();
+    for (cpu = 0; cpu < CPU_TOPOLOGY_MAX_CPUS; cpu++) {
+        if (!mOnline.test(cpu))
+            continue;
+        snprintf(path, sizeof(path), CPU_THREAD_SIBLINGS, cpu);
+        if (read_cpu_list(path, &siblings))
+            return false;
+        snprintf(path, sizeof(path), CPU_L2_SHARED, cpu);
+        if (read_cpu_list(path, &l2))
+            return false;
+
+        /* an L2 shared beyond the SMT siblings is an E-core module */
+        if (l2.count() > siblings.count())
+            mEfficiency.set(cpu);
+        else
+            mPerformance.set(cpu);
+    }
+    return mPerformance.any() && mEfficiency.any();
+}
+
+void CpuTopology::probe()
+{
+    const char *source = "none";
+
+    if (read_cpu_list(CPU_ONLINE, &mOnline) || mOnline.none())
+        mOnline.set(0);
+
+    if (probePmu())
+        source = "pmu";
+    else if (probeCapacity())
+        source = "cpu_capacity";
+    else if (probeCacheDomains())
+        source = "cache";
+
+    mHybrid = strcmp(source, "none") != 0;
+    if (!mHybrid) {
+        mPerformance = mOnline;
+        mEfficiency.reset();
+    }
+
+    formatCpuList(mPerformance, mPerformanceList, sizeof(mPerformanceList));
+    formatCpuList(mEfficiency, mEfficiencyList, sizeof(mEfficiencyList));
+    ALOGI("CPU topology (%s): P-cores %s, E-cores %s", source,
+          mPerformanceList, mHybrid ? mEfficiencyList : "none");
+}
@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 2014 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_CPU_TOPOLOGY_H
+#define ANDROID_CPU_TOPOLOGY_H
+
+#include <bitset>
+
+#define CPU_TOPOLOGY_MAX_CPUS 256
+#define CPU_LIST_MAX 64
+
+typedef std::bitset<CPU_TOPOLOGY_MAX_CPUS> cpu_mask_t;
+
+/**
+ * Probes which online cpus are performance (P) and efficiency (E) cores.
+ * In order of preference the probe uses the hybrid PMU cpu lists
+ * (cpu_core/cpu_atom), per-cpu cpu_capacity and finally the L2 cache
+ * domains: E-cores share an L2 per module, P-cores only with their SMT
+ * sibling. Non-hybrid parts report every cpu as a P-core.
+ */
+class CpuTopology {
+
+  public:
+      CpuTopology();
+      virtual ~CpuTopology(){};
+      void probe();
+      bool isHybrid() const { return mHybrid; };
+      const cpu_mask_t &online() const { return mOnline; };
+      const cpu_mask_t &performanceCores() const { return mPerformance; };
+      const cpu_mask_t &efficiencyCores() const { return mEfficiency; };
+      /* cpuset list strings, e.g. "0-7" */
+      const char *performanceCpus() const { return mPerformanceList; };
+      const char *efficiencyCpus() const { return mEfficiencyList; };
+
+      static int parseCpuList(const char *list, cpu_mask_t *mask);
+      static void formatCpuList(const cpu_mask_t &mask, char *list, size_t size);
+
+  private:
+      bool mHybrid;
+      cpu_mask_t mOnline;
+      cpu_mask_t mPerformance;
+      cpu_mask_t mEfficiency;
+      char mPerformanceList[CPU_LIST_MAX];
+      char mEfficiencyList[CPU_LIST_MAX];
+
+      bool probePmu();
+      bool probeCapacity();
+      bool probeCacheDomains();
+};
+#endif  // ANDROID_CPU_TOPOLOGY_H
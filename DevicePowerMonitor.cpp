@@ -17,97 +17,649 @@
 #define LOG_TAG "PowerHAL"
 
 #include "DevicePowerMonitor.h"
+#include "PowerFs.h"
 
 #include <cutils/log.h>
+#include <cutils/properties.h>
 #include <errno.h>
+#include <linux/netlink.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
 
 static const char* HAL_DIR = "/sys/power/power_HAL_suspend";
 static const char* DEVICE_CONTROL_FILE = "power_HAL_suspend";
+/* 0 keeps the serial transition path */
+static const char* POWER_HAL_DEVICE_WORKERS_PROPERTY = "persist.powerhal.device_workers";
+static const char* POWER_HAL_RESUME_TIMEOUT_PROPERTY = "persist.powerhal.resume_timeout_ms";
+static const char* POWER_HAL_VERIFY_WRITES_PROPERTY = "persist.powerhal.verify_writes"; /* for userdebug, eng build */
 
-void DevicePowerMonitor::scanPaths()
+#define DEFAULT_DEVICE_WORKERS 4
+#define DEFAULT_RESUME_TIMEOUT_MS 500
+/* devices slower than this are reported so slow drivers stand out */
+#define SLOW_DEVICE_US 2000
+#define UEVENT_MSG_LEN 2048
+
+/* indexed by the target state */
+static const char DEVICE_PAYLOADS[2][2] = { "1", "0" };
+
+static long long now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000LL + ts.tv_nsec / 1000;
+}
+
+int DevicePowerMonitor::findDevice(const char *name)
+{
+    size_t i;
+
+    for(i = 0; i < mNumDevices; i++)
+        if(!strcmp(mDevices[i].name, name))
+            return i;
+    return -1;
+}
+
+/* the only place a device path is built; transitions write to the fd */
+int DevicePowerMonitor::openDevice(const char *name)
 {
     char deviceNamePath[PATH_MAX];
-    DIR *dir;
-    struct dirent *de;
-    int cnt = 0;
 
-    if(!mScanNeeded)
+    snprintf(deviceNamePath, sizeof(deviceNamePath), "%s/%s/%s", HAL_DIR, name, DEVICE_CONTROL_FILE);
+    return PowerFs::get()->open(deviceNamePath, (mVerifyWrites ? O_RDWR : O_WRONLY) | O_CLOEXEC);
+}
+
+void DevicePowerMonitor::addDevice(const char *name)
+{
+    int phase;
+    int fd;
+    int q;
+
+    if(findDevice(name) >= 0)
+        return;
+
+    if(DevicePowerMonitorInfo::isBlacklisted(name)){
+        ALOGD("Found device: %s in blacklist", name);
+        return;
+    }
+    if(strlen(name) >= DEVICE_NAME_MAX || mNumDevices == DEVICE_TABLE_MAX){
+        ALOGW("Not tracking device %s: %s", name,
+              mNumDevices == DEVICE_TABLE_MAX ? "device table full" : "name too long");
+        return;
+    }
+    fd = openDevice(name);
+    if(fd < 0){
+        ALOGE("Could not open '%s/%s/%s': %s", HAL_DIR, name, DEVICE_CONTROL_FILE, strerror(errno));
+        return;
+    }
+
+    /*
+     * Open a slot at the end of the target phase by moving the first
+     * device of every later phase to the end of that phase.
+     */
+    phase = DevicePowerMonitorInfo::devicePhase(name);
+    mNumDevices++;
+    for(q = DevicePowerMonitorInfo::NUM_PHASES - 1; q > phase; q--){
+        size_t first = mPhaseEnd[q - 1];
+        if(first != mPhaseEnd[q])
+            mDevices[mPhaseEnd[q]] = mDevices[first];
+        mPhaseEnd[q]++;
+    }
+
+    DeviceEntry &e = mDevices[mPhaseEnd[phase]];
+    e.fd = fd;
+    e.phase = phase;
+    e.applied = -1;
+    e.writing = false;
+    e.errors = 0;
+    strcpy(e.name, name);
+    mPhaseEnd[phase]++;
+    ALOGV("Tracking device %s (phase %d)", name, phase);
+}
+
+void DevicePowerMonitor::removeDevice(const char *name)
+{
+    int idx = findDevice(name);
+    size_t hole;
+    int q;
+
+    if(idx < 0)
+        return;
+
+    /* Fill the hole with the last device of its phase, then ripple down */
+    hole = idx;
+    PowerFs::get()->close(mDevices[hole].fd);
+    for(q = mDevices[hole].phase; q < DevicePowerMonitorInfo::NUM_PHASES; q++){
+        size_t last = mPhaseEnd[q] - 1;
+        if(last != hole){
+            mDevices[hole] = mDevices[last];
+            hole = last;
+        }
+        mPhaseEnd[q]--;
+    }
+    mNumDevices--;
+    ALOGV("Dropped device %s", name);
+}
+
+void DevicePowerMonitor::refreshDevice(const char *name)
+{
+    char deviceNamePath[PATH_MAX];
+    int idx = findDevice(name);
+    int fd;
+
+    snprintf(deviceNamePath, sizeof(deviceNamePath), "%s/%s/%s", HAL_DIR, name, DEVICE_CONTROL_FILE);
+    if(PowerFs::get()->access(deviceNamePath, W_OK) != 0){
+        removeDevice(name);
+        return;
+    }
+    if(idx < 0){
+        addDevice(name);
+        return;
+    }
+
+    /* the node was recreated or failed; reopen it in place, state unknown */
+    fd = openDevice(name);
+    if(fd < 0){
+        removeDevice(name);
+        return;
+    }
+    PowerFs::get()->close(mDevices[idx].fd);
+    mDevices[idx].fd = fd;
+    mDevices[idx].applied = -1;
+}
+
+void DevicePowerMonitor::queueChange(const char *name)
+{
+    size_t i;
+
+    for(i = 0; i < mNumChanged; i++)
+        if(!strcmp(mChangedDevices[i], name))
+            return;
+    /* a hotplug storm: rescan everything before the next transition */
+    if(mNumChanged == DEVICE_CHANGES_MAX || strlen(name) >= DEVICE_NAME_MAX){
+        mScanNeeded = true;
         return;
+    }
+    strcpy(mChangedDevices[mNumChanged++], name);
+}
+
+void DevicePowerMonitor::applyChanges()
+{
+    size_t i;
+
+    if(mInFlight)
+        return;
+    for(i = 0; i < mNumChanged; i++)
+        refreshDevice(mChangedDevices[i]);
+    mNumChanged = 0;
+}
+
+void DevicePowerMonitor::scanPaths()
+{
+    PowerFs *fs = PowerFs::get();
+    std::vector<std::string> names;
+    size_t i;
 
-    mDevicePaths.erase(mDevicePaths.begin(), mDevicePaths.end());
-    dir = opendir(HAL_DIR);
-    if(dir == NULL){
+    if(!mScanNeeded || mInFlight)
+        return;
+
+    for(i = 0; i < mNumDevices; i++)
+        fs->close(mDevices[i].fd);
+    mNumDevices = 0;
+    mNumChanged = 0;
+    memset(mPhaseEnd, 0, sizeof(mPhaseEnd));
+    if(fs->listDir(HAL_DIR, &names)){
         ALOGE("Could not open directory '%s': %s", HAL_DIR, strerror(errno));
         return;
     }
-    while((de = readdir(dir))) {
-        if(de->d_name[0] == '.')
+    for(i = 0; i < names.size(); i++) {
+        if(names[i][0] == '.')
             continue;
+        addDevice(names[i].c_str());
+    }
+    if(mNumDevices > 0){
+        mScanNeeded = false;
+    }
+}
 
-        snprintf(deviceNamePath, sizeof(deviceNamePath), "%s/%s/%s", HAL_DIR, de->d_name, DEVICE_CONTROL_FILE);
-        int fd = ::open(deviceNamePath, O_WRONLY);
-        if(fd < 0){
-            ALOGE("Could not open file '%s': %s", deviceNamePath, strerror(errno));
-            continue;
-        }
-        close(fd);
-
-        bool blacklist = false;
-        unsigned int i;
-        for(i = 0;  i < DevicePowerMonitorInfo::numDev; i++){
-            if(!strncmp(DevicePowerMonitorInfo::deviceBlackList[i], de->d_name,
-	       strlen(DevicePowerMonitorInfo::deviceBlackList[i]))){
-                ALOGD("Found device: %s in blacklist", de->d_name);
-                blacklist = true;
-                break;
-            }
+bool DevicePowerMonitor::startListener()
+{
+    struct sockaddr_nl addr;
+
+    mUeventFd = socket(PF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC, NETLINK_KOBJECT_UEVENT);
+    if(mUeventFd < 0){
+        ALOGE("Could not open uevent socket: %s", strerror(errno));
+        return false;
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.nl_family = AF_NETLINK;
+    addr.nl_pid = 0;
+    addr.nl_groups = 1;
+    if(bind(mUeventFd, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+       pthread_create(&mListener, NULL, listenerLoop, this)){
+        ALOGE("Could not listen for uevents: %s", strerror(errno));
+        close(mUeventFd);
+        mUeventFd = -1;
+        return false;
+    }
+    return true;
+}
+
+void *DevicePowerMonitor::listenerLoop(void *arg)
+{
+    DevicePowerMonitor *self = (DevicePowerMonitor *)arg;
+    char msg[UEVENT_MSG_LEN + 2];
+    ssize_t n;
+
+    while(1){
+        n = recv(self->mUeventFd, msg, UEVENT_MSG_LEN, 0);
+        if(n <= 0){
+            if(n < 0 && errno == EINTR)
+                continue;
+            ALOGE("uevent socket failed, falling back to rescans: %s", strerror(errno));
+            break;
         }
+        msg[n] = '\0';
+        msg[n + 1] = '\0';
 
-        if(!blacklist){
-            snprintf(deviceNamePath, sizeof(deviceNamePath), "%s/%s/%s", HAL_DIR, de->d_name, DEVICE_CONTROL_FILE);
-            mDevicePaths.push_back(deviceNamePath);
+        /* "action@devpath" header followed by NUL separated KEY=value pairs */
+        const char *action = NULL;
+        const char *devpath = NULL;
+        for(char *cp = msg; *cp; cp += strlen(cp) + 1){
+            if(!strncmp(cp, "ACTION=", 7))
+                action = cp + 7;
+            else if(!strncmp(cp, "DEVPATH=", 8))
+                devpath = cp + 8;
         }
+        if(!action || !devpath || (strcmp(action, "add") && strcmp(action, "remove")))
+            continue;
+
+        const char *name = strrchr(devpath, '/');
+        name = name ? name + 1 : devpath;
+        if(!*name)
+            continue;
+
+        pthread_mutex_lock(&self->mLock);
+        self->queueChange(name);
+        /* never reshuffle the inventory under an in-flight transition */
+        if(self->mPending == 0)
+            self->applyChanges();
+        pthread_mutex_unlock(&self->mLock);
     }
-    if(mDevicePaths.size() > 0){
+
+    pthread_mutex_lock(&self->mLock);
+    close(self->mUeventFd);
+    self->mUeventFd = -1;
+    self->mScanNeeded = true;
+    pthread_mutex_unlock(&self->mLock);
+    return NULL;
+}
+
+void DevicePowerMonitor::configure()
+{
+    pthread_condattr_t attr;
+    int i;
+
+    mConfigured = true;
+    mNumWorkers = property_get_int32(POWER_HAL_DEVICE_WORKERS_PROPERTY, DEFAULT_DEVICE_WORKERS);
+    mResumeTimeoutMs = property_get_int32(POWER_HAL_RESUME_TIMEOUT_PROPERTY, DEFAULT_RESUME_TIMEOUT_MS);
+    if (mNumWorkers > DEVICE_WORKERS_MAX)
+        mNumWorkers = DEVICE_WORKERS_MAX;
+    if (mNumWorkers < 0)
+        mNumWorkers = 0;
+#ifdef POWERHAL_DEBUG
+    mVerifyWrites = property_get_bool(POWER_HAL_VERIFY_WRITES_PROPERTY, false);
+#endif
+
+    pthread_mutex_init(&mLock, NULL);
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&mDoneCond, &attr);
+    pthread_condattr_destroy(&attr);
+    pthread_cond_init(&mWorkCond, NULL);
+    pthread_cond_init(&mSlotCond, NULL);
+
+    /*
+     * One full scan at start-up; from then on hotplug keeps the inventory
+     * current. Without uevents we fall back to rescanning between
+     * transitions whenever a node disappears.
+     */
+    scanPaths();
+    if (startListener())
         mScanNeeded = false;
+
+    for (i = 0; i < mNumWorkers; i++) {
+        if (pthread_create(&mWorkers[i], NULL, workerLoop, this)) {
+            ALOGE("Could not start device power worker %d", i);
+            break;
+        }
+    }
+    /* fall back to serial transitions if no worker could be started */
+    mNumWorkers = i;
+}
+
+int DevicePowerMonitor::writeDevice(int fd, const char *name, int state, int applied)
+{
+    long long start;
+    long long elapsed;
+    ssize_t ret;
+    /* power_HAL_suspend takes 1 to suspend and 0 to resume */
+    const char *value = DEVICE_PAYLOADS[state ? 1 : 0];
+    char current;
+    PowerFs *fs = PowerFs::get();
+
+    /*
+     * Proximity/display churn repeats the same state; skip no-op writes.
+     * applied is only ever known while no other write is on the node.
+     */
+    if (applied == state && !mVerifyWrites)
+        return DEVICE_WRITE_SKIPPED;
+    if (fd < 0)
+        return DEVICE_WRITE_NO_NODE;
+
+    start = now_us();
+    if (applied == state) {
+        if (fs->pread(fd, &current, 1, 0) == 1 && current == value[0])
+            return DEVICE_WRITE_SKIPPED;
+        ALOGW("Cached state of %s is stale, rewriting", name);
+    }
+
+    ret = fs->pwrite(fd, value, 1, 0);
+    if (ret < 0) {
+        ALOGE("Error writing %s to %s errno:%d", value, name, errno);
+        /* the device went away under the open fd */
+        if (errno == ENODEV || errno == ENOENT || errno == EBADF)
+            return DEVICE_WRITE_NO_NODE;
+        return DEVICE_WRITE_FAILED;
     }
+    if (mVerifyWrites && (fs->pread(fd, &current, 1, 0) != 1 || current != value[0]))
+        ALOGW("Read-back of %s does not match %s", name, value);
 
-    closedir(dir);
+    elapsed = now_us() - start;
+    mWriteHist.record(elapsed * 1000);
+    if (elapsed > SLOW_DEVICE_US)
+        ALOGI("Slow device %s: %s took %lld us", state ? "resume" : "suspend", name, elapsed);
+    else
+        ALOGV("Device %s: %s took %lld us", state ? "resume" : "suspend", name, elapsed);
+    return DEVICE_WRITE_OK;
 }
 
-void DevicePowerMonitor::setState(int state)
+void DevicePowerMonitor::setApplied(size_t idx, int state, int ret)
 {
-    unsigned int quitLoop = 0;
-    ssize_t ret = 0;
-    scanPaths();
-    std::vector<std::string>::iterator it=mDevicePaths.begin();
-    while(it != mDevicePaths.end())
-    {
-        int fd = ::open((char*) it->c_str(), O_WRONLY);
-        if(fd < 0){
-            ALOGE("Could not open the file:%s", (char*) it->c_str());
-            /*
-                We might have issue that the kernel removed the node so we need to re-scan.
-                However if we have permission problem we do not want to be stuck forever in this loop
-            */
-            mScanNeeded = true;
-            scanPaths();
-            it = mDevicePaths.begin();
-            if(quitLoop++ > 0)
-                break;
+    if (ret == DEVICE_WRITE_NO_NODE)
+        noteFailure(idx);
+    mDevices[idx].applied = ret >= 0 ? state : -1;
+    if (ret < 0)
+        mDevices[idx].errors++;
+}
+
+void *DevicePowerMonitor::workerLoop(void *arg)
+{
+    DevicePowerMonitor *self = (DevicePowerMonitor *)arg;
+    unsigned int generation;
+    size_t idx;
+    bool critical;
+    int applied;
+    int state;
+    int ret;
+    int fd;
+
+    pthread_mutex_lock(&self->mLock);
+    while (1) {
+        while (self->mNextDevice >= self->mBatchSize) {
+            if (self->mQueuedPhases)
+                self->nextQueuedPhase();
+            else
+                pthread_cond_wait(&self->mWorkCond, &self->mLock);
+        }
+
+        /* resume walks the phases in order, suspend walks them backwards */
+        idx = self->mNextDevice++;
+        state = self->mTargetState;
+        if (!state)
+            idx = self->mBatchSize - 1 - idx;
+        idx += self->mBatchFirst;
+        generation = self->mGeneration;
+        /* mInFlight keeps the slot, and so the name, where it is */
+        self->mInFlight++;
+
+        /*
+         * A write from an older transition may still be running on this
+         * device. Wait for it so the newest state is always written last;
+         * if an even newer transition took over meanwhile, leave the
+         * device to that one.
+         */
+        while (self->mDevices[idx].writing && generation == self->mGeneration)
+            pthread_cond_wait(&self->mSlotCond, &self->mLock);
+        if (generation != self->mGeneration) {
+            self->mInFlight--;
+            if (self->mPending == 0)
+                self->applyChanges();
+            pthread_cond_broadcast(&self->mDoneCond);
             continue;
         }
 
-        if(state){
-            ret = write(fd, "0", 1);
+        DeviceEntry &e = self->mDevices[idx];
+        fd = e.fd;
+        critical = e.phase == DevicePowerMonitorInfo::PHASE_CRITICAL;
+        applied = e.applied;
+        /* unknown until this write lands, so nothing skips against it */
+        e.applied = -1;
+        e.writing = true;
+        pthread_mutex_unlock(&self->mLock);
+
+        ret = self->writeDevice(fd, e.name, state, applied);
+
+        pthread_mutex_lock(&self->mLock);
+        self->mInFlight--;
+        e.writing = false;
+        pthread_cond_broadcast(&self->mSlotCond);
+        /*
+         * A newer transition reset the batch; this result no longer
+         * counts and the node stays unknown, so the newer write happens.
+         */
+        if (generation != self->mGeneration) {
+            if (ret == DEVICE_WRITE_NO_NODE)
+                self->noteFailure(idx);
+            if (self->mPending == 0)
+                self->applyChanges();
+            pthread_cond_broadcast(&self->mDoneCond);
+            continue;
         }
-        else{
-            ret = write(fd, "1", 1);
+        self->setApplied(idx, state, ret);
+        if (critical && --self->mPendingCritical == 0)
+            pthread_cond_broadcast(&self->mDoneCond);
+        if (--self->mPending == 0) {
+            self->mTransitionHist.record((now_us() - self->mBatchStart) * 1000);
+            self->applyChanges();
+            pthread_cond_broadcast(&self->mDoneCond);
+            ALOGV("Device transition to %d done in %lld us", state,
+                  now_us() - self->mBatchStart);
+        }
+    }
+    return NULL;
+}
+
+/* table slots [*first, *end) holding the devices of phases firstPhase..lastPhase */
+void DevicePowerMonitor::phaseRange(int firstPhase, int lastPhase, size_t *first, size_t *end)
+{
+    *first = firstPhase > 0 ? mPhaseEnd[firstPhase - 1] : 0;
+    *end = mPhaseEnd[lastPhase];
+}
+
+/* start the next queued phase, in the same order a full transition walks them */
+void DevicePowerMonitor::nextQueuedPhase()
+{
+    int phase = mTargetState ? __builtin_ctz(mQueuedPhases) : 31 - __builtin_clz(mQueuedPhases);
+    size_t end;
+
+    mQueuedPhases &= ~(1u << phase);
+    phaseRange(phase, phase, &mBatchFirst, &end);
+    mBatchSize = end - mBatchFirst;
+    mNextDevice = 0;
+}
+
+void DevicePowerMonitor::setStateParallel(int state, int firstPhase, int lastPhase)
+{
+    struct timespec deadline;
+    size_t first, end;
+    int phase;
+    int ret = 0;
+
+    pthread_mutex_lock(&mLock);
+    if (mPending > 0 && state == mTargetState) {
+        /*
+         * The same state is still being written, e.g. the devices stage
+         * of a screen-off when the critical stage follows right away.
+         * Queue the phases behind it rather than dropping what the
+         * workers have not reached yet; the inventory stays as it is
+         * until the batch drains.
+         */
+        phaseRange(firstPhase, lastPhase, &first, &end);
+        for (phase = firstPhase; phase <= lastPhase; phase++)
+            mQueuedPhases |= 1u << phase;
+        mPending += end - first;
+        if (state && firstPhase == DevicePowerMonitorInfo::PHASE_CRITICAL)
+            mPendingCritical += mPhaseEnd[DevicePowerMonitorInfo::PHASE_CRITICAL];
+    } else {
+        scanPaths();
+        applyChanges();
+        phaseRange(firstPhase, lastPhase, &first, &end);
+
+        /*
+         * Supersede any transition still running. Its in-flight writes carry
+         * on, but every device of the new batch waits for its own one to
+         * finish, so this state is the last one written.
+         */
+        mGeneration++;
+        pthread_cond_broadcast(&mSlotCond);
+        mTargetState = state;
+        mNextDevice = 0;
+        mBatchFirst = first;
+        mBatchSize = mPending = end - first;
+        mQueuedPhases = 0;
+        mPendingCritical = state && firstPhase == DevicePowerMonitorInfo::PHASE_CRITICAL ?
+                mPhaseEnd[DevicePowerMonitorInfo::PHASE_CRITICAL] : 0;
+        mBatchStart = now_us();
+    }
+    pthread_cond_broadcast(&mWorkCond);
+
+    /*
+     * Only the display/input critical devices are waited for on resume;
+     * the other phases and the whole suspend complete in the background.
+     */
+    if (mPendingCritical > 0) {
+        clock_gettime(CLOCK_MONOTONIC, &deadline);
+        deadline.tv_sec += mResumeTimeoutMs / 1000;
+        deadline.tv_nsec += (mResumeTimeoutMs % 1000) * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
         }
-        if (ret < 0)
-            ALOGE("Error when trying to write to the file errno:%d", errno);
-        close(fd);
-        it++;
+        while (mPendingCritical > 0 && ret != ETIMEDOUT)
+            ret = pthread_cond_timedwait(&mDoneCond, &mLock, &deadline);
+        if (mPendingCritical > 0)
+            ALOGW("Resume timed out after %d ms, %zu of %zu critical devices pending",
+                  mResumeTimeoutMs, mPendingCritical,
+                  mPhaseEnd[DevicePowerMonitorInfo::PHASE_CRITICAL]);
+        else
+            ALOGV("Critical devices resumed in %lld us", now_us() - mBatchStart);
+        mCriticalResumeHist.record((now_us() - mBatchStart) * 1000);
+    }
+    /* an empty range has no worker to finish it */
+    if (mPending == 0)
+        applyChanges();
+    pthread_mutex_unlock(&mLock);
+}
+
+void DevicePowerMonitor::noteFailure(size_t idx)
+{
+    /*
+        We might have issue that the kernel removed the node. Without a
+        uevent listener, rescan before the next transition; either way the
+        current transition carries on with the remaining devices.
+    */
+    if (mUeventFd < 0)
+        mScanNeeded = true;
+    else
+        queueChange(mDevices[idx].name);
+}
 
+void DevicePowerMonitor::setStateSerial(int state, int firstPhase, int lastPhase)
+{
+    long long start = now_us();
+    size_t first, end, i;
+
+    pthread_mutex_lock(&mLock);
+    scanPaths();
+    applyChanges();
+    phaseRange(firstPhase, lastPhase, &first, &end);
+    /* mPending keeps the listener from reshuffling the table under us */
+    mPending = end - first;
+    for(i = 0; i < end - first; i++)
+    {
+        /* resume walks the phases in order, suspend walks them backwards */
+        size_t idx = state ? first + i : end - 1 - i;
+        DeviceEntry &e = mDevices[idx];
+        setApplied(idx, state, writeDevice(e.fd, e.name, state, e.applied));
     }
+    mPending = 0;
+    applyChanges();
+    pthread_mutex_unlock(&mLock);
+    mTransitionHist.record((now_us() - start) * 1000);
+}
+
+void DevicePowerMonitor::setState(int state)
+{
+    setState(state, 0, DevicePowerMonitorInfo::NUM_PHASES - 1);
+}
+
+void DevicePowerMonitor::setState(int state, int firstPhase, int lastPhase)
+{
+    if (!mConfigured)
+        configure();
+
+    if (mNumWorkers > 0)
+        setStateParallel(state, firstPhase, lastPhase);
+    else
+        setStateSerial(state, firstPhase, lastPhase);
+}
+
+void DevicePowerMonitor::waitIdle()
+{
+    if (!mConfigured)
+        return;
+
+    pthread_mutex_lock(&mLock);
+    /* mDoneCond also fires whenever a batch drains or a stale write ends */
+    while (mPending > 0 || mInFlight > 0)
+        pthread_cond_wait(&mDoneCond, &mLock);
+    pthread_mutex_unlock(&mLock);
+}
+
+void DevicePowerMonitor::dump(int fd)
+{
+    size_t i;
+
+    if (!mConfigured) {
+        dprintf(fd, "devices: not configured\n");
+        return;
+    }
+
+    pthread_mutex_lock(&mLock);
+    dprintf(fd, "devices: %zu tracked, %zu critical, %d workers, uevents %s\n",
+            mNumDevices, mPhaseEnd[DevicePowerMonitorInfo::PHASE_CRITICAL],
+            mNumWorkers, mUeventFd >= 0 ? "on" : "off");
+    for (i = 0; i < mNumDevices; i++)
+        dprintf(fd, "  %s: phase=%d state=%d errors=%u\n", mDevices[i].name,
+                mDevices[i].phase, mDevices[i].applied, mDevices[i].errors);
+    pthread_mutex_unlock(&mLock);
+    mWriteHist.dump(fd);
+    mCriticalResumeHist.dump(fd);
+    mTransitionHist.dump(fd);
 }
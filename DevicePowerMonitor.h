@@ -17,18 +17,22 @@
 #ifndef ANDROID_POWER_MONITOR_H
 #define ANDROID_POWER_MONITOR_H
 
-#include <string>
-
 #include <dirent.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <stdint.h>
-#include <vector>
+#include <pthread.h>
 
 #include "DevicePowerMonitorInfo.h"
+#include "LatencyHistogram.h"
 
-#define DEVICE_NAME_MAX 256
+#define DEVICE_NAME_MAX 64
+/* power_HAL_suspend devices tracked at once; later ones are ignored */
+#define DEVICE_TABLE_MAX 128
+/* hotplug reports queued between transitions before a full rescan */
+#define DEVICE_CHANGES_MAX 32
+#define DEVICE_WORKERS_MAX 8
 
 struct sensors_event_t;
 
@@ -39,16 +43,127 @@ struct sensors_event_t;
 class DevicePowerMonitor {
 
   private:
-      std::vector<std::string> mDevicePaths;
+      struct DeviceEntry {
+          /* power_HAL_suspend node, open for as long as the device is tracked */
+          int fd;
+          int phase;
+          /* last state successfully written, -1 if unknown */
+          int applied;
+          /* a worker is writing the node; one writer per device at a time */
+          bool writing;
+          unsigned int errors;
+          char name[DEVICE_NAME_MAX];
+      };
+
+      enum {
+          DEVICE_WRITE_SKIPPED = 1,
+          DEVICE_WRITE_OK = 0,
+          DEVICE_WRITE_NO_NODE = -1,
+          DEVICE_WRITE_FAILED = -2,
+      };
+
+      /*
+       * Fixed table ordered by DevicePowerMonitorInfo phase, critical
+       * devices first; mPhaseEnd[p] is one past the last device of phase
+       * p. Slots only move on hotplug or a rescan, never while a write is
+       * in flight, so a transition writes straight from the table without
+       * allocating, formatting or resolving a path.
+       */
+      DeviceEntry mDevices[DEVICE_TABLE_MAX];
+      size_t mNumDevices;
+      size_t mPhaseEnd[DevicePowerMonitorInfo::NUM_PHASES];
+      /* devices reported by the uevent listener, applied between transitions */
+      char mChangedDevices[DEVICE_CHANGES_MAX][DEVICE_NAME_MAX];
+      size_t mNumChanged;
       bool mScanNeeded;
-      void cleanPaths();
+      int mUeventFd;
+      pthread_t mListener;
       void scanPaths();
+      int findDevice(const char *name);
+      int openDevice(const char *name);
+      void addDevice(const char *name);
+      void removeDevice(const char *name);
+      void refreshDevice(const char *name);
+      void queueChange(const char *name);
+      void applyChanges();
+      void noteFailure(size_t idx);
+      bool startListener();
+      static void *listenerLoop(void *arg);
+
+      /*
+       * Parallel transitions: devices are handed out to a small worker
+       * pool one at a time. mLock protects everything below as well as
+       * the inventory above.
+       */
+      int mNumWorkers;
+      int mResumeTimeoutMs;
+      bool mConfigured;
+      /* debug: read nodes back instead of trusting the applied cache */
+      bool mVerifyWrites;
+      pthread_t mWorkers[DEVICE_WORKERS_MAX];
+      pthread_mutex_t mLock;
+      pthread_cond_t mWorkCond;
+      pthread_cond_t mDoneCond;
+      /* signalled whenever a device write finishes */
+      pthread_cond_t mSlotCond;
+      unsigned int mGeneration;
+      int mTargetState;
+      size_t mNextDevice;
+      /* the batch covers table slots [mBatchFirst, mBatchFirst + mBatchSize) */
+      size_t mBatchFirst;
+      size_t mBatchSize;
+      /* phases of mTargetState to hand out once the batch is, e.g. the next screen-off stage */
+      unsigned int mQueuedPhases;
+      size_t mPending;
+      size_t mPendingCritical;
+      /* writes running outside mLock; the table stays put while nonzero */
+      unsigned int mInFlight;
+      long long mBatchStart;
+
+      LatencyHistogram mWriteHist;
+      LatencyHistogram mCriticalResumeHist;
+      LatencyHistogram mTransitionHist;
+
+      void configure();
+      int writeDevice(int fd, const char *name, int state, int applied);
+      void setApplied(size_t idx, int state, int ret);
+      void phaseRange(int firstPhase, int lastPhase, size_t *first, size_t *end);
+      void nextQueuedPhase();
+      void setStateSerial(int state, int firstPhase, int lastPhase);
+      void setStateParallel(int state, int firstPhase, int lastPhase);
+      static void *workerLoop(void *arg);
 
   public:
       DevicePowerMonitor():
-          mScanNeeded(true){};
+          mNumDevices(0),
+          mPhaseEnd(),
+          mNumChanged(0),
+          mScanNeeded(true),
+          mUeventFd(-1),
+          mNumWorkers(0),
+          mResumeTimeoutMs(0),
+          mConfigured(false),
+          mVerifyWrites(false),
+          mGeneration(0),
+          mTargetState(0),
+          mNextDevice(0),
+          mBatchFirst(0),
+          mBatchSize(0),
+          mQueuedPhases(0),
+          mPending(0),
+          mPendingCritical(0),
+          mInFlight(0),
+          mBatchStart(0),
+          mWriteHist("device_write"),
+          mCriticalResumeHist("device_resume_critical"),
+          mTransitionHist("device_transition"){};
       virtual ~DevicePowerMonitor(){};
       void setState(int state);
+      /* only the devices of phases firstPhase..lastPhase, e.g. a staged screen-off */
+      void setState(int state, int firstPhase, int lastPhase);
+      /* block until every write handed out so far has finished, e.g. for benchmarks */
+      void waitIdle();
+      void dump(int fd);
 
 };
 #endif  // ANDROID_I2C_POWER_MONITOR_H
@@ -16,9 +16,46 @@
 
 #include "DevicePowerMonitorInfo.h"
 
+#include <string.h>
+#include <string>
+#include <unordered_set>
+
 const char* DevicePowerMonitorInfo::deviceBlackList[] = {
     "0000:00:02.0" /* i915 to blacklist */
 };
 
 const unsigned int DevicePowerMonitorInfo::numDev = \
 	sizeof(DevicePowerMonitorInfo::deviceBlackList) / sizeof(char *);
+
+bool DevicePowerMonitorInfo::isBlacklisted(const char* name)
+{
+    /* built on first use; device names are matched exactly */
+    static const std::unordered_set<std::string> blacklist(deviceBlackList,
+                                                           deviceBlackList + numDev);
+
+    return blacklist.count(name) > 0;
+}
+
+/* matched by prefix against the entries in /sys/power/power_HAL_suspend */
+const DevicePowerMonitorInfo::PhaseEntry DevicePowerMonitorInfo::devicePhaseTable[] = {
+    { "0000:00:15.", PHASE_CRITICAL }, /* LPSS I2C: touchscreen/touchpad */
+    { "0000:00:14.0", PHASE_CRITICAL }, /* xHCI: USB input devices */
+    { "i2c-", PHASE_CRITICAL },        /* i2c HID input devices */
+    { "0000:00:17.0", PHASE_LATE },    /* SATA storage */
+    { "0000:00:1f.3", PHASE_LATE },    /* HD audio */
+    { "0000:00:13.0", PHASE_LATE },    /* ISH sensor hub */
+};
+
+const unsigned int DevicePowerMonitorInfo::numPhaseEntries = \
+	sizeof(DevicePowerMonitorInfo::devicePhaseTable) / sizeof(DevicePowerMonitorInfo::PhaseEntry);
+
+int DevicePowerMonitorInfo::devicePhase(const char* name)
+{
+    unsigned int i;
+
+    for(i = 0; i < numPhaseEntries; i++){
+        if(!strncmp(devicePhaseTable[i].prefix, name, strlen(devicePhaseTable[i].prefix)))
+            return devicePhaseTable[i].phase;
+    }
+    return PHASE_NORMAL;
+}
@@ -21,8 +21,24 @@ class DevicePowerMonitorInfo {
 private:
     DevicePowerMonitorInfo() {};
 public:
+    /* Resume order; suspend runs the phases in reverse */
+    enum {
+        PHASE_CRITICAL = 0, /* display/input path, resumed before returning */
+        PHASE_NORMAL,       /* anything not listed below */
+        PHASE_LATE,         /* storage/audio/sensors, resumed last */
+        NUM_PHASES
+    };
+    struct PhaseEntry {
+        const char* prefix;
+        int phase;
+    };
+
     virtual ~DevicePowerMonitorInfo(){};
     static const unsigned int numDev;
     static const char* deviceBlackList[];
+    static bool isBlacklisted(const char* name);
+    static const unsigned int numPhaseEntries;
+    static const PhaseEntry devicePhaseTable[];
+    static int devicePhase(const char* name);
 };
 #endif //ANDROID_I2C_DEVICE_POWER_MONITOR_INFO
@@ -0,0 +1,371 @@
+/*
+ * Copyright (C) 2014 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "PowerHAL"
+
+#include "EppController.h"
+#include "PowerFs.h"
+
+#include <cutils/log.h>
+#include <cutils/properties.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <vector>
+
+static const char* CPUFREQ_DIR = "/sys/devices/system/cpu/cpufreq";
+static const char* POWER_HAL_EPP_PROPERTY = "ro.powerhal.epp.";
+static const char* POWER_HAL_EPP_PROPERTY_DEBUG = "persist.powerhal.epp."; /* for userdebug, eng build tuning*/
+
+static const char* EPP_POLICY_NODES[] = {
+    "scaling_max_freq",
+    "scaling_min_freq",
+    "energy_performance_preference",
+};
+
+static const char* EPP_MODE_NAMES[EppController::NUM_MODES] = {
+    "interactive",
+    "idle",
+    "launch",
+    "sustained",
+    "low_power",
+};
+
+/*
+ * Defaults: launch ramps straight up and keeps a floor, sustained stays
+ * clear of the turbo range so it can hold its clocks, low power and
+ * screen-off lean towards efficiency.
+ */
+static const struct {
+    const char *epp;
+    int minPct;
+    int maxPct;
+} EPP_MODE_DEFAULTS[EppController::NUM_MODES] = {
+    { "balance_performance", 0, 100 },
+    { "power", 0, 100 },
+    { "performance", 60, 100 },
+    { "balance_performance", 0, 80 },
+    { "balance_power", 0, 60 },
+};
+
+static long read_khz(const char *policy, const char *node)
+{
+    char path[PATH_MAX];
+    char buf[32];
+
+    snprintf(path, sizeof(path), "%s/%s/%s", CPUFREQ_DIR, policy, node);
+    if (PowerFs::get()->readFile(path, buf, sizeof(buf)))
+        return -1;
+    return atol(buf);
+}
+
+EppController::EppController():
+    mNumPolicies(0),
+    mActuator(NULL),
+    mInteractive(true),
+    mMode(-1),
+    mCapPct(100),
+    mSwitchHist("epp_switch")
+{
+    pthread_mutex_init(&mLock, NULL);
+    memset(mRequests, 0, sizeof(mRequests));
+    memset(mSwitches, 0, sizeof(mSwitches));
+}
+
+EppController::~EppController()
+{
+    int i, n;
+
+    for (i = 0; i < mNumPolicies; i++)
+        for (n = 0; n < NUM_NODES; n++)
+            delete mPolicies[i].nodes[n];
+}
+
+bool EppController::addPolicy(const char *name)
+{
+    char path[PATH_MAX];
+    char governor[32];
+    Policy *p;
+    int n;
+
+    if (mNumPolicies >= EPP_MAX_POLICIES)
+        return false;
+
+    /* intel_pstate rejects EPP changes under the performance policy */
+    snprintf(path, sizeof(path), "%s/%s/scaling_governor", CPUFREQ_DIR, name);
+    if (PowerFs::get()->readFile(path, governor, sizeof(governor)) || strcmp(governor, "powersave"))
+        return false;
+
+    for (n = 0; n < NUM_NODES; n++) {
+        snprintf(path, sizeof(path), "%s/%s/%s", CPUFREQ_DIR, name, EPP_POLICY_NODES[n]);
+        if (PowerFs::get()->access(path, W_OK))
+            return false;
+    }
+
+    p = &mPolicies[mNumPolicies];
+    snprintf(p->name, sizeof(p->name), "%s", name);
+    p->minKhz = read_khz(name, "cpuinfo_min_freq");
+    p->maxKhz = read_khz(name, "cpuinfo_max_freq");
+    if (p->minKhz <= 0 || p->maxKhz < p->minKhz)
+        return false;
+    p->floorKhz = read_khz(name, "scaling_min_freq");
+    p->ceilingKhz = read_khz(name, "scaling_max_freq");
+    if (p->floorKhz <= 0 || p->ceilingKhz < p->floorKhz) {
+        p->floorKhz = p->minKhz;
+        p->ceilingKhz = p->maxKhz;
+    }
+    for (n = 0; n < NUM_NODES; n++) {
+        snprintf(path, sizeof(path), "%s/%s/%s", CPUFREQ_DIR, name, EPP_POLICY_NODES[n]);
+        p->nodes[n] = new SysfsNode(path);
+        p->ids[n] = -1;
+    }
+    mNumPolicies++;
+    return true;
+}
+
+void EppController::loadModes(const char *available)
+{
+    /* mode property names are longer than the legacy PROPERTY_KEY_MAX */
+    char prop[PROPERTY_VALUE_MAX];
+    char value[PROPERTY_VALUE_MAX];
+    char *cursor;
+    char *field;
+    int m;
+
+    for (m = 0; m < NUM_MODES; m++) {
+        int len = 0;
+
+        snprintf(mModes[m].epp, EPP_VALUE_MAX, "%s", EPP_MODE_DEFAULTS[m].epp);
+        mModes[m].minPct = EPP_MODE_DEFAULTS[m].minPct;
+        mModes[m].maxPct = EPP_MODE_DEFAULTS[m].maxPct;
+
+#ifdef POWERHAL_DEBUG
+        snprintf(prop, sizeof(prop), "%s%s", POWER_HAL_EPP_PROPERTY_DEBUG, EPP_MODE_NAMES[m]);
+        len = property_get(prop, value, NULL);
+#endif
+        if (len <= 0) {
+            snprintf(prop, sizeof(prop), "%s%s", POWER_HAL_EPP_PROPERTY, EPP_MODE_NAMES[m]);
+            len = property_get(prop, value, NULL);
+        }
+        if (len > 0) {
+            /* "epp;min_pct;max_pct", empty fields keep the default */
+            cursor = value;
+            if ((field = strsep(&cursor, ";")) && *field)
+                snprintf(mModes[m].epp, EPP_VALUE_MAX, "%s", field);
+            if ((field = strsep(&cursor, ";")) && *field)
+                mModes[m].minPct = atoi(field);
+            if ((field = strsep(&cursor, ";")) && *field)
+                mModes[m].maxPct = atoi(field);
+        }
+
+        if (mModes[m].maxPct > 100 || mModes[m].maxPct <= 0)
+            mModes[m].maxPct = 100;
+        if (mModes[m].minPct < 0)
+            mModes[m].minPct = 0;
+        if (mModes[m].minPct > mModes[m].maxPct)
+            mModes[m].minPct = mModes[m].maxPct;
+
+        /* raw numeric preferences are always accepted */
+        if (available[0] && (mModes[m].epp[0] < '0' || mModes[m].epp[0] > '9')
+                && !strstr(available, mModes[m].epp))
+            ALOGW("EPP %s for mode %s is not offered (%s)", mModes[m].epp,
+                  EPP_MODE_NAMES[m], available);
+    }
+}
+
+bool EppController::probe()
+{
+    std::vector<std::string> names;
+    char path[PATH_MAX];
+    char available[128];
+    size_t i;
+
+    if (PowerFs::get()->listDir(CPUFREQ_DIR, &names))
+        return false;
+    for (i = 0; i < names.size(); i++) {
+        if (names[i].compare(0, 6, "policy"))
+            continue;
+        if (!addPolicy(names[i].c_str()))
+            ALOGV("cpufreq %s has no writable HWP controls", names[i].c_str());
+    }
+    if (!mNumPolicies)
+        return false;
+
+    snprintf(path, sizeof(path), "%s/%s/energy_performance_available_preferences",
+             CPUFREQ_DIR, mPolicies[0].name);
+    if (PowerFs::get()->readFile(path, available, sizeof(available)))
+        available[0] = '\0';
+    loadModes(available);
+    ALOGI("EPP control on %d cpufreq policies", mNumPolicies);
+    return true;
+}
+
+void EppController::attachActuator(SysfsActuator *actuator)
+{
+    int i, n;
+
+    pthread_mutex_lock(&mLock);
+    mActuator = actuator;
+    /* policy-major order keeps max ahead of min within each policy */
+    for (i = 0; i < mNumPolicies; i++)
+        for (n = 0; n < NUM_NODES; n++)
+            mPolicies[i].ids[n] = actuator->addNode(mPolicies[i].nodes[n], false);
+    pthread_mutex_unlock(&mLock);
+}
+
+void EppController::writeNode(Policy *p, int node, const char *value)
+{
+    if (mActuator && p->ids[node] >= 0)
+        mActuator->post(p->ids[node], value);
+    else
+        p->nodes[node]->write(value);
+}
+
+int EppController::selectMode()
+{
+    if (!mInteractive)
+        return MODE_IDLE;
+    if (mRequests[MODE_LAUNCH])
+        return MODE_LAUNCH;
+    if (mRequests[MODE_SUSTAINED])
+        return MODE_SUSTAINED;
+    if (mRequests[MODE_LOW_POWER])
+        return MODE_LOW_POWER;
+    return MODE_INTERACTIVE;
+}
+
+void EppController::applyMode(int mode, bool force)
+{
+    struct timespec start, end;
+    const Mode *m = &mModes[mode];
+    int maxPct = m->maxPct < mCapPct ? m->maxPct : mCapPct;
+    int minPct = m->minPct < maxPct ? m->minPct : maxPct;
+    char freq[ACTUATOR_VALUE_MAX];
+    long floorKhz;
+    long ceilingKhz;
+    int i;
+
+    if (mode == mMode && !force)
+        return;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < mNumPolicies; i++) {
+        Policy *p = &mPolicies[i];
+        long range = p->maxKhz - p->minKhz;
+
+        /*
+         * cpufreq rejects a min above the current max and a max below
+         * the current min. Raising the window moves the ceiling first,
+         * lowering it moves the floor first, so every step stays valid.
+         * The actuator skips values a policy already has.
+         */
+        floorKhz = p->minKhz + range * minPct / 100;
+        ceilingKhz = p->minKhz + range * maxPct / 100;
+        if (ceilingKhz >= p->ceilingKhz) {
+            snprintf(freq, sizeof(freq), "%ld", ceilingKhz);
+            writeNode(p, NODE_MAX_FREQ, freq);
+            snprintf(freq, sizeof(freq), "%ld", floorKhz);
+            writeNode(p, NODE_MIN_FREQ, freq);
+        } else {
+            snprintf(freq, sizeof(freq), "%ld", floorKhz);
+            writeNode(p, NODE_MIN_FREQ, freq);
+            snprintf(freq, sizeof(freq), "%ld", ceilingKhz);
+            writeNode(p, NODE_MAX_FREQ, freq);
+        }
+        p->floorKhz = floorKhz;
+        p->ceilingKhz = ceilingKhz;
+        writeNode(p, NODE_EPP, m->epp);
+    }
+    if (mode == mMode)
+        return;
+    ALOGV("EPP mode %s", EPP_MODE_NAMES[mode]);
+    mSwitches[mode]++;
+    mMode = mode;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    mSwitchHist.record((end.tv_sec - start.tv_sec) * 1000000000LL +
+                       (end.tv_nsec - start.tv_nsec));
+}
+
+void EppController::setState(int state)
+{
+    if (!active())
+        return;
+
+    pthread_mutex_lock(&mLock);
+    mInteractive = state != 0;
+    applyMode(selectMode());
+    pthread_mutex_unlock(&mLock);
+}
+
+void EppController::requestMode(int mode, bool active)
+{
+    if (!this->active() || mode < 0 || mode >= NUM_MODES)
+        return;
+
+    pthread_mutex_lock(&mLock);
+    mRequests[mode] = active;
+    applyMode(selectMode());
+    pthread_mutex_unlock(&mLock);
+}
+
+void EppController::setMaxCap(int pct)
+{
+    if (!active())
+        return;
+
+    pthread_mutex_lock(&mLock);
+    if (pct != mCapPct) {
+        mCapPct = pct;
+        applyMode(selectMode(), true);
+    }
+    pthread_mutex_unlock(&mLock);
+}
+
+int EppController::mode()
+{
+    int mode;
+
+    pthread_mutex_lock(&mLock);
+    mode = mMode;
+    pthread_mutex_unlock(&mLock);
+    return mode;
+}
+
+void EppController::dump(int fd)
+{
+    int m, i;
+
+    if (!active()) {
+        dprintf(fd, "epp: not available\n");
+        return;
+    }
+
+    pthread_mutex_lock(&mLock);
+    dprintf(fd, "epp: policies=%d mode=%s cap=%d%%\n", mNumPolicies,
+            mMode >= 0 ? EPP_MODE_NAMES[mMode] : "none", mCapPct);
+    for (m = 0; m < NUM_MODES; m++)
+        dprintf(fd, "  %s: %s min=%d%% max=%d%% switches=%u requested=%d\n", EPP_MODE_NAMES[m],
+                mModes[m].epp, mModes[m].minPct, mModes[m].maxPct, mSwitches[m], mRequests[m]);
+    for (i = 0; i < mNumPolicies; i++)
+        dprintf(fd, "  %s: %ld-%ld kHz (epp writes=%u errors=%u)\n", mPolicies[i].name,
+                mPolicies[i].minKhz, mPolicies[i].maxKhz,
+                mPolicies[i].nodes[NODE_EPP]->writes(), mPolicies[i].nodes[NODE_EPP]->writeErrors());
+    pthread_mutex_unlock(&mLock);
+    mSwitchHist.dump(fd);
+}
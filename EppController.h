@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2014 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_EPP_CONTROLLER_H
+#define ANDROID_EPP_CONTROLLER_H
+
+#include <pthread.h>
+
+#include "LatencyHistogram.h"
+#include "SysfsActuator.h"
+#include "SysfsNode.h"
+
+#define EPP_MAX_POLICIES 64
+/* "balance_performance" or a raw 0-255 value */
+#define EPP_VALUE_MAX 24
+
+/**
+ * Energy-aware intel_pstate control for HWP parts. Each power mode maps
+ * to an energy_performance_preference and an HWP min/max window (as a
+ * percentage of the cpuinfo range) written to every cpufreq policy. A
+ * mode switch posts all policies to the actuator at once, so they land
+ * in a single drain.
+ */
+class EppController {
+
+  public:
+      enum {
+          MODE_INTERACTIVE = 0,
+          MODE_IDLE,           /* screen off */
+          MODE_LAUNCH,
+          MODE_SUSTAINED,
+          MODE_LOW_POWER,
+          NUM_MODES
+      };
+
+      EppController();
+      virtual ~EppController();
+      /* find HWP policies; false if the platform has none */
+      bool probe();
+      bool active() const { return mNumPolicies > 0; };
+      /* route policy writes through the actuator; call before it starts */
+      void attachActuator(SysfsActuator *actuator);
+      void setState(int state);
+      /* hint-driven modes; screen-off always wins */
+      void requestMode(int mode, bool active);
+      /* upper bound on every mode's max, e.g. from the thermal loop */
+      void setMaxCap(int pct);
+      int mode();
+      void dump(int fd);
+
+  private:
+      enum {
+          NODE_MAX_FREQ = 0,
+          NODE_MIN_FREQ,
+          NODE_EPP,
+          NUM_NODES
+      };
+      struct Policy {
+          char name[16];
+          SysfsNode *nodes[NUM_NODES];
+          int ids[NUM_NODES];
+          long minKhz;
+          long maxKhz;
+          /* scaling window last written, to order the next change */
+          long floorKhz;
+          long ceilingKhz;
+      };
+      struct Mode {
+          char epp[EPP_VALUE_MAX];
+          int minPct;
+          int maxPct;
+      };
+
+      Policy mPolicies[EPP_MAX_POLICIES];
+      int mNumPolicies;
+      Mode mModes[NUM_MODES];
+      SysfsActuator *mActuator;
+      bool mInteractive;
+      bool mRequests[NUM_MODES];
+      int mMode;
+      int mCapPct;
+      pthread_mutex_t mLock;
+      unsigned int mSwitches[NUM_MODES];
+      LatencyHistogram mSwitchHist;
+
+      bool addPolicy(const char *name);
+      void loadModes(const char *available);
+      int selectMode();
+      void applyMode(int mode, bool force = false);
+      void writeNode(Policy *p, int node, const char *value);
+};
+#endif  // ANDROID_EPP_CONTROLLER_H
@@ -0,0 +1,386 @@
+/*
+ * Copyright (C) 2014 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "PowerHAL"
+
+#include "GovernorBackend.h"
+#include "PowerFs.h"
+
+#include <cutils/log.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <vector>
+
+static const char* CPUFREQ_DIR = "/sys/devices/system/cpu/cpufreq";
+static const char* INTERACTIVE_PULSE = "/sys/devices/system/cpu/cpufreq/interactive/touchboostpulse";
+static const char* INTERACTIVE_BOOST = "/sys/devices/system/cpu/cpufreq/interactive/boost";
+static const char* INTERACTIVE_PULSE_DURATION = "/sys/devices/system/cpu/cpufreq/interactive/boostpulse_duration";
+static const char* INTEL_PSTATE_MIN_PERF = "/sys/devices/system/cpu/intel_pstate/min_perf_pct";
+static const char* INTEL_PSTATE_MAX_PERF = "/sys/devices/system/cpu/intel_pstate/max_perf_pct";
+static const char* UCLAMP_MIN = "/dev/cpuctl/top-app/cpu.uclamp.min";
+
+/* interactive governor default boostpulse_duration */
+#define INTERACTIVE_PULSE_DEFAULT_NS 80000000LL
+
+static int read_int(const char *path, int def)
+{
+    char buf[32];
+
+    if (PowerFs::get()->readFile(path, buf, sizeof(buf)))
+        return def;
+    return atoi(buf);
+}
+
+static long read_khz(const char *policy, const char *node)
+{
+    char path[PATH_MAX];
+    char buf[32];
+
+    snprintf(path, sizeof(path), "%s/%s/%s", CPUFREQ_DIR, policy, node);
+    if (PowerFs::get()->readFile(path, buf, sizeof(buf)))
+        return -1;
+    return atol(buf);
+}
+
+void GovernorBackend::dump(int fd)
+{
+    dprintf(fd, "governor: %s\n", name());
+}
+
+GovernorBackend *GovernorBackend::select()
+{
+    static InteractiveGovernor interactive;
+    static IntelPstateGovernor intelPstate;
+    static UclampGovernor uclamp;
+    static CpufreqGovernor cpufreq;
+    static NullGovernor none;
+    GovernorBackend *backends[] = { &interactive, &intelPstate, &uclamp, &cpufreq };
+    size_t i;
+
+    for (i = 0; i < sizeof(backends) / sizeof(backends[0]); i++)
+        if (backends[i]->probe()) {
+            ALOGI("CPU boosts through the %s backend", backends[i]->name());
+            return backends[i];
+        }
+    ALOGI("No CPU frequency boost backend");
+    return &none;
+}
+
+InteractiveGovernor::InteractiveGovernor():
+    mScaling("interactive"),
+    mPulseNode(INTERACTIVE_PULSE),
+    mBoostNode(INTERACTIVE_BOOST),
+    mActuator(NULL),
+    mArbiter(NULL),
+    mPulseId(-1),
+    mBoostKnob(-1),
+    mPulseNs(INTERACTIVE_PULSE_DEFAULT_NS)
+{
+}
+
+bool InteractiveGovernor::probe()
+{
+    int us;
+
+    if (PowerFs::get()->access(INTERACTIVE_PULSE, W_OK))
+        return false;
+    /* the pulse is written at input rate, so keep both nodes open */
+    if (mPulseNode.open())
+        return false;
+    mBoostNode.open();
+    us = read_int(INTERACTIVE_PULSE_DURATION, 0);
+    if (us > 0)
+        mPulseNs = us * 1000LL;
+    if (!mScaling.probe())
+        ALOGW("No writable scaling_max_freq, sustained mode cannot cap the interactive governor");
+    return true;
+}
+
+void InteractiveGovernor::attach(SysfsActuator *actuator, BoostArbiter *arbiter)
+{
+    mActuator = actuator;
+    mArbiter = arbiter;
+    mPulseId = actuator->addNode(&mPulseNode, true);
+    mBoostKnob = arbiter->addKnob("interactive_boost", actuator,
+            actuator->addNode(&mBoostNode, false), BoostArbiter::AGGREGATE_MAX, 0);
+    if (mScaling.canCap())
+        mScaling.attach(actuator, arbiter);
+}
+
+void InteractiveGovernor::pulse()
+{
+    mActuator->post(mPulseId, "1");
+}
+
+void InteractiveGovernor::hold(int requester, int pct)
+{
+    /* the governor only knows boosted or not */
+    if (pct > 0)
+        mArbiter->request(mBoostKnob, requester, 1);
+    else
+        mArbiter->cancel(mBoostKnob, requester);
+}
+
+void InteractiveGovernor::cap(int requester, int pct)
+{
+    if (mScaling.canCap())
+        mScaling.cap(requester, pct);
+}
+
+IntelPstateGovernor::IntelPstateGovernor():
+    mMinPerfNode(INTEL_PSTATE_MIN_PERF, O_RDWR),
+    mMaxPerfNode(INTEL_PSTATE_MAX_PERF, O_RDWR),
+    mArbiter(NULL),
+    mMinPerfDefault(-1),
+    mMaxPerfDefault(-1),
+    mMinPerfKnob(-1),
+    mMaxPerfKnob(-1)
+{
+}
+
+bool IntelPstateGovernor::probe()
+{
+    mMinPerfDefault = read_int(INTEL_PSTATE_MIN_PERF, -1);
+    if (mMinPerfDefault < 0)
+        return false;
+    mMaxPerfDefault = read_int(INTEL_PSTATE_MAX_PERF, -1);
+    mMinPerfNode.open();
+    if (mMaxPerfDefault >= 0)
+        mMaxPerfNode.open();
+    return true;
+}
+
+void IntelPstateGovernor::attach(SysfsActuator *actuator, BoostArbiter *arbiter)
+{
+    mArbiter = arbiter;
+    mMinPerfKnob = arbiter->addKnob("min_perf_pct", actuator,
+            actuator->addNode(&mMinPerfNode, false), BoostArbiter::AGGREGATE_MAX,
+            mMinPerfDefault);
+    if (mMaxPerfDefault >= 0)
+        mMaxPerfKnob = arbiter->addKnob("max_perf_pct", actuator,
+                actuator->addNode(&mMaxPerfNode, false), BoostArbiter::AGGREGATE_MIN,
+                mMaxPerfDefault);
+}
+
+void IntelPstateGovernor::hold(int requester, int pct)
+{
+    if (pct > 0)
+        mArbiter->request(mMinPerfKnob, requester, pct);
+    else
+        mArbiter->cancel(mMinPerfKnob, requester);
+}
+
+void IntelPstateGovernor::cap(int requester, int pct)
+{
+    /* a thermal cap outranks any other max_perf_pct request */
+    if (pct >= 100)
+        mArbiter->cancel(mMaxPerfKnob, requester);
+    else
+        mArbiter->request(mMaxPerfKnob, requester, pct, BoostArbiter::PRIORITY_CRITICAL);
+}
+
+UclampGovernor::UclampGovernor():
+    mScaling("schedutil")
+{
+}
+
+bool UclampGovernor::probe()
+{
+    char path[PATH_MAX];
+    char governor[16];
+
+    /* uclamp only steers frequency under schedutil */
+    snprintf(path, sizeof(path), "%s/policy0/scaling_governor", CPUFREQ_DIR);
+    if (PowerFs::get()->readFile(path, governor, sizeof(governor)) || strcmp(governor, "schedutil"))
+        return false;
+    if (PowerFs::get()->access(UCLAMP_MIN, W_OK))
+        return false;
+    if (!mScaling.probe())
+        ALOGW("No writable scaling_max_freq, sustained mode cannot cap schedutil");
+    return true;
+}
+
+void UclampGovernor::attach(SysfsActuator *actuator, BoostArbiter *arbiter)
+{
+    if (mScaling.canCap())
+        mScaling.attach(actuator, arbiter);
+}
+
+void UclampGovernor::cap(int requester, int pct)
+{
+    if (mScaling.canCap())
+        mScaling.cap(requester, pct);
+}
+
+CpufreqGovernor::CpufreqGovernor(const char *governor):
+    mNumPolicies(0),
+    mOnly(governor),
+    mActuator(NULL),
+    mArbiter(NULL),
+    mFloorKnob(-1),
+    mCapKnob(-1),
+    mFloorPct(0),
+    mCapPct(100)
+{
+    mGovernor[0] = '\0';
+}
+
+CpufreqGovernor::~CpufreqGovernor()
+{
+    int i, n;
+
+    for (i = 0; i < mNumPolicies; i++)
+        for (n = 0; n < NUM_NODES; n++)
+            delete mPolicies[i].nodes[n];
+}
+
+bool CpufreqGovernor::addPolicy(const char *name)
+{
+    static const char* POLICY_NODES[NUM_NODES] = { "scaling_max_freq", "scaling_min_freq" };
+    char path[PATH_MAX];
+    char governor[16];
+    Policy *p;
+    int n;
+
+    if (mNumPolicies >= GOVERNOR_MAX_POLICIES)
+        return false;
+
+    /* powersave/performance policies belong to intel_pstate and EPP */
+    snprintf(path, sizeof(path), "%s/%s/scaling_governor", CPUFREQ_DIR, name);
+    if (PowerFs::get()->readFile(path, governor, sizeof(governor)))
+        return false;
+    if (mOnly ? strcmp(governor, mOnly) : strcmp(governor, "ondemand")
+            && strcmp(governor, "conservative") && strcmp(governor, "schedutil"))
+        return false;
+
+    p = &mPolicies[mNumPolicies];
+    snprintf(p->name, sizeof(p->name), "%s", name);
+    p->minKhz = read_khz(name, "cpuinfo_min_freq");
+    p->maxKhz = read_khz(name, "cpuinfo_max_freq");
+    p->floorKhz = read_khz(name, "scaling_min_freq");
+    p->capKhz = read_khz(name, "scaling_max_freq");
+    if (p->minKhz <= 0 || p->maxKhz < p->minKhz || p->floorKhz <= 0 || p->capKhz <= 0)
+        return false;
+    for (n = 0; n < NUM_NODES; n++) {
+        snprintf(path, sizeof(path), "%s/%s/%s", CPUFREQ_DIR, name, POLICY_NODES[n]);
+        if (PowerFs::get()->access(path, W_OK))
+            break;
+    }
+    if (n < NUM_NODES)
+        return false;
+    for (n = 0; n < NUM_NODES; n++) {
+        snprintf(path, sizeof(path), "%s/%s/%s", CPUFREQ_DIR, name, POLICY_NODES[n]);
+        p->nodes[n] = new SysfsNode(path);
+        p->ids[n] = -1;
+    }
+    if (!mGovernor[0])
+        snprintf(mGovernor, sizeof(mGovernor), "%s", governor);
+    mNumPolicies++;
+    return true;
+}
+
+bool CpufreqGovernor::probe()
+{
+    std::vector<std::string> names;
+    size_t i;
+
+    if (PowerFs::get()->listDir(CPUFREQ_DIR, &names))
+        return false;
+    for (i = 0; i < names.size(); i++)
+        if (!names[i].compare(0, 6, "policy"))
+            addPolicy(names[i].c_str());
+    return mNumPolicies > 0;
+}
+
+void CpufreqGovernor::attach(SysfsActuator *actuator, BoostArbiter *arbiter)
+{
+    int i, n;
+
+    mActuator = actuator;
+    mArbiter = arbiter;
+    /* policy-major order keeps max ahead of min within each policy */
+    for (i = 0; i < mNumPolicies; i++)
+        for (n = 0; n < NUM_NODES; n++)
+            mPolicies[i].ids[n] = actuator->addNode(mPolicies[i].nodes[n], false);
+    mFloorKnob = arbiter->addKnob("scaling_min_freq", applyFloor, this,
+                                  BoostArbiter::AGGREGATE_MAX, 0);
+    mCapKnob = arbiter->addKnob("scaling_max_freq", applyCap, this,
+                                BoostArbiter::AGGREGATE_MIN, 100);
+}
+
+/* called from the arbiter callbacks, so under the arbiter lock */
+void CpufreqGovernor::apply()
+{
+    char freq[16];
+    int i;
+
+    for (i = 0; i < mNumPolicies; i++) {
+        Policy *p = &mPolicies[i];
+        long range = p->maxKhz - p->minKhz;
+        long capKhz = mCapPct >= 100 ? p->capKhz : p->minKhz + range * mCapPct / 100;
+        long floorKhz = mFloorPct <= 0 ? p->floorKhz : p->minKhz + range * mFloorPct / 100;
+
+        if (floorKhz > capKhz)
+            floorKhz = capKhz;
+        /* the actuator skips values a policy already has */
+        snprintf(freq, sizeof(freq), "%ld", capKhz);
+        mActuator->post(p->ids[NODE_MAX_FREQ], freq);
+        snprintf(freq, sizeof(freq), "%ld", floorKhz);
+        mActuator->post(p->ids[NODE_MIN_FREQ], freq);
+    }
+}
+
+void CpufreqGovernor::applyFloor(int pct, void *arg)
+{
+    CpufreqGovernor *self = (CpufreqGovernor *)arg;
+
+    self->mFloorPct = pct;
+    self->apply();
+}
+
+void CpufreqGovernor::applyCap(int pct, void *arg)
+{
+    CpufreqGovernor *self = (CpufreqGovernor *)arg;
+
+    self->mCapPct = pct;
+    self->apply();
+}
+
+void CpufreqGovernor::hold(int requester, int pct)
+{
+    if (pct > 0)
+        mArbiter->request(mFloorKnob, requester, pct);
+    else
+        mArbiter->cancel(mFloorKnob, requester);
+}
+
+void CpufreqGovernor::cap(int requester, int pct)
+{
+    if (pct >= 100)
+        mArbiter->cancel(mCapKnob, requester);
+    else
+        mArbiter->request(mCapKnob, requester, pct, BoostArbiter::PRIORITY_CRITICAL);
+}
+
+void CpufreqGovernor::dump(int fd)
+{
+    dprintf(fd, "governor: %s (%s) policies=%d floor=%d%% cap=%d%%\n", name(), mGovernor,
+            mNumPolicies, mFloorPct, mCapPct);
+}
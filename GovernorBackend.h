@@ -0,0 +1,207 @@
+/*
+ * Copyright (C) 2014 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_GOVERNOR_BACKEND_H
+#define ANDROID_GOVERNOR_BACKEND_H
+
+#include "BoostArbiter.h"
+#include "SysfsActuator.h"
+#include "SysfsNode.h"
+
+#define GOVERNOR_MAX_POLICIES 64
+
+/**
+ * CPU frequency boosting for one kind of governor. select() probes the
+ * backends from the most to the least specific once at init; the hint
+ * path then only calls through the chosen backend.
+ *
+ * Level boosts are arbiter requests, so hold() is keyed by the caller's
+ * arbiter requester id and several holders aggregate to the highest
+ * level. Callers run it from lease callbacks.
+ */
+class GovernorBackend {
+
+  public:
+      virtual ~GovernorBackend(){};
+      virtual const char *name() const = 0;
+      /* true when the kernel offers this backend's knobs */
+      virtual bool probe() = 0;
+      /* register nodes and arbiter knobs before the actuator starts */
+      virtual void attach(SysfsActuator *actuator, BoostArbiter *arbiter) = 0;
+      /* whether touch input should boost through this backend at all */
+      virtual bool touchBoost() const { return true; };
+      /* governors with a self-timed boost pulse, e.g. interactive */
+      virtual bool hasPulse() const { return false; };
+      virtual void pulse() {};
+      virtual long long pulseNs() const { return 0; };
+      /* hold a performance floor in percent of the range; 0 releases */
+      virtual void hold(int requester, int pct) = 0;
+      /* cap performance in percent of the range; 100 lifts the cap */
+      virtual void cap(__attribute__((unused))int requester, __attribute__((unused))int pct) {};
+      /* false when cap() does nothing, so no thermal loop should rely on it */
+      virtual bool canCap() const { return false; };
+      virtual void dump(int fd);
+
+      /* best backend the kernel offers; a no-op backend if none */
+      static GovernorBackend *select();
+};
+
+/*
+ * Any other cpufreq governor (ondemand, conservative, schedutil without
+ * uclamp): scaling_min_freq/scaling_max_freq of every policy, driven as
+ * one floor and one cap in percent of each policy's range.
+ */
+class CpufreqGovernor : public GovernorBackend {
+
+  public:
+      /* governor limits the policies to those running it; NULL takes any above */
+      CpufreqGovernor(const char *governor = NULL);
+      virtual ~CpufreqGovernor();
+      virtual const char *name() const { return "cpufreq"; };
+      virtual bool probe();
+      virtual void attach(SysfsActuator *actuator, BoostArbiter *arbiter);
+      virtual void hold(int requester, int pct);
+      virtual void cap(int requester, int pct);
+      virtual bool canCap() const { return mNumPolicies > 0; };
+      virtual void dump(int fd);
+
+  private:
+      enum {
+          NODE_MAX_FREQ = 0,   /* posted first so a raised min always fits */
+          NODE_MIN_FREQ,
+          NUM_NODES
+      };
+      struct Policy {
+          char name[16];
+          SysfsNode *nodes[NUM_NODES];
+          int ids[NUM_NODES];
+          long minKhz;
+          long maxKhz;
+          /* scaling limits found at init */
+          long floorKhz;
+          long capKhz;
+      };
+
+      Policy mPolicies[GOVERNOR_MAX_POLICIES];
+      int mNumPolicies;
+      const char *mOnly;
+      char mGovernor[16];
+      SysfsActuator *mActuator;
+      BoostArbiter *mArbiter;
+      int mFloorKnob;
+      int mCapKnob;
+      /* effective values, only touched from the arbiter callbacks */
+      int mFloorPct;
+      int mCapPct;
+
+      bool addPolicy(const char *name);
+      void apply();
+      static void applyFloor(int pct, void *arg);
+      static void applyCap(int pct, void *arg);
+};
+
+/* interactive governor: touchboostpulse plus the boost level */
+class InteractiveGovernor : public GovernorBackend {
+
+  public:
+      InteractiveGovernor();
+      virtual ~InteractiveGovernor(){};
+      virtual const char *name() const { return "interactive"; };
+      virtual bool probe();
+      virtual void attach(SysfsActuator *actuator, BoostArbiter *arbiter);
+      virtual bool hasPulse() const { return true; };
+      virtual void pulse();
+      virtual long long pulseNs() const { return mPulseNs; };
+      virtual void hold(int requester, int pct);
+      /* the governor has no cap of its own; scaling_max_freq carries it */
+      virtual void cap(int requester, int pct);
+      virtual bool canCap() const { return mScaling.canCap(); };
+
+  private:
+      CpufreqGovernor mScaling;
+      SysfsNode mPulseNode;
+      SysfsNode mBoostNode;
+      SysfsActuator *mActuator;
+      BoostArbiter *mArbiter;
+      int mPulseId;
+      int mBoostKnob;
+      long long mPulseNs;
+};
+
+/*
+ * intel_pstate: min_perf_pct floor and max_perf_pct cap. HWP already
+ * ramps on input, so touch does not raise the floor.
+ */
+class IntelPstateGovernor : public GovernorBackend {
+
+  public:
+      IntelPstateGovernor();
+      virtual ~IntelPstateGovernor(){};
+      virtual const char *name() const { return "intel_pstate"; };
+      virtual bool probe();
+      virtual void attach(SysfsActuator *actuator, BoostArbiter *arbiter);
+      virtual bool touchBoost() const { return false; };
+      virtual void hold(int requester, int pct);
+      virtual void cap(int requester, int pct);
+      virtual bool canCap() const { return mMaxPerfDefault >= 0; };
+
+  private:
+      SysfsNode mMinPerfNode;
+      SysfsNode mMaxPerfNode;
+      BoostArbiter *mArbiter;
+      /* values read once at init, restored when the last request ends */
+      int mMinPerfDefault;
+      int mMaxPerfDefault;
+      int mMinPerfKnob;
+      int mMaxPerfKnob;
+};
+
+/*
+ * schedutil with uclamp: frequency follows the clamped utilisation, so
+ * CGroupBoostController's cpu.uclamp.min requests carry the touch and
+ * launch boosts. This backend never raises scaling_min_freq; it only
+ * caps scaling_max_freq for the thermal loop.
+ */
+class UclampGovernor : public GovernorBackend {
+
+  public:
+      UclampGovernor();
+      virtual ~UclampGovernor(){};
+      virtual const char *name() const { return "schedutil_uclamp"; };
+      virtual bool probe();
+      virtual void attach(SysfsActuator *actuator, BoostArbiter *arbiter);
+      virtual bool touchBoost() const { return false; };
+      virtual void hold(__attribute__((unused))int requester, __attribute__((unused))int pct) {};
+      virtual void cap(int requester, int pct);
+      virtual bool canCap() const { return mScaling.canCap(); };
+
+  private:
+      CpufreqGovernor mScaling;
+};
+
+/* nothing to boost; touch falls back to the cgroup boost */
+class NullGovernor : public GovernorBackend {
+
+  public:
+      virtual ~NullGovernor(){};
+      virtual const char *name() const { return "none"; };
+      virtual bool probe() { return true; };
+      virtual void attach(__attribute__((unused))SysfsActuator *actuator,
+                          __attribute__((unused))BoostArbiter *arbiter) {};
+      virtual bool touchBoost() const { return false; };
+      virtual void hold(__attribute__((unused))int requester, __attribute__((unused))int pct) {};
+};
+#endif  // ANDROID_GOVERNOR_BACKEND_H
@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2014 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "PowerHAL"
+
+#include "GpuBoostController.h"
+#include "PowerFs.h"
+
+#include <cutils/log.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+static const char* GT_MIN_FREQ = "/sys/class/drm/card0/gt_min_freq_mhz";
+static const char* GT_MAX_FREQ = "/sys/class/drm/card0/gt_max_freq_mhz";
+static const char* GT_BOOST_FREQ = "/sys/class/drm/card0/gt_boost_freq_mhz";
+static const char* GT_RPN_FREQ = "/sys/class/drm/card0/gt_RPn_freq_mhz";
+static const char* GT_RP0_FREQ = "/sys/class/drm/card0/gt_RP0_freq_mhz";
+
+static int read_mhz(const char *path)
+{
+    char buf[32];
+
+    if (PowerFs::get()->readFile(path, buf, sizeof(buf)))
+        return -1;
+    return atoi(buf);
+}
+
+GpuBoostController::GpuBoostController():
+    mMinNode(GT_MIN_FREQ),
+    mBoostNode(GT_BOOST_FREQ),
+    mArbiter(NULL),
+    mRpnMhz(-1),
+    mRp0Mhz(-1),
+    mMaxMhz(-1),
+    mMinDefault(-1),
+    mBoostDefault(-1),
+    mMinKnob(-1),
+    mBoostKnob(-1)
+{
+}
+
+bool GpuBoostController::probe()
+{
+    mRpnMhz = read_mhz(GT_RPN_FREQ);
+    mRp0Mhz = read_mhz(GT_RP0_FREQ);
+    mMinDefault = read_mhz(GT_MIN_FREQ);
+    mMaxMhz = read_mhz(GT_MAX_FREQ);
+    if (mRpnMhz <= 0 || mRp0Mhz <= mRpnMhz || mMinDefault < 0 ||
+        PowerFs::get()->access(GT_MIN_FREQ, W_OK)) {
+        ALOGI("No i915 frequency controls, GPU boost off");
+        return false;
+    }
+    if (mMaxMhz <= 0)
+        mMaxMhz = mRp0Mhz;
+    /* the boost clock is optional; older kernels only have min/max */
+    mBoostDefault = read_mhz(GT_BOOST_FREQ);
+    mMinNode.open();
+    if (mBoostDefault > 0)
+        mBoostNode.open();
+    ALOGI("GPU boost between %d and %d MHz", mRpnMhz, mMaxMhz);
+    return true;
+}
+
+void GpuBoostController::attach(SysfsActuator *actuator, BoostArbiter *arbiter)
+{
+    mArbiter = arbiter;
+    mMinKnob = arbiter->addKnob("gt_min_freq_mhz", actuator,
+            actuator->addNode(&mMinNode, false), BoostArbiter::AGGREGATE_MAX, mMinDefault);
+    if (mBoostDefault > 0)
+        mBoostKnob = arbiter->addKnob("gt_boost_freq_mhz", actuator,
+                actuator->addNode(&mBoostNode, false), BoostArbiter::AGGREGATE_MAX,
+                mBoostDefault);
+}
+
+void GpuBoostController::hold(int requester, int pct)
+{
+    int mhz;
+
+    if (!mArbiter)
+        return;
+    if (pct <= 0) {
+        mArbiter->cancel(mMinKnob, requester);
+        mArbiter->cancel(mBoostKnob, requester);
+        return;
+    }
+    if (pct > 100)
+        pct = 100;
+    mhz = mRpnMhz + (mRp0Mhz - mRpnMhz) * pct / 100;
+    if (mhz > mMaxMhz)
+        mhz = mMaxMhz;
+    /* never lower either clock below where it booted */
+    mArbiter->request(mMinKnob, requester, mhz > mMinDefault ? mhz : mMinDefault);
+    mArbiter->request(mBoostKnob, requester, mhz > mBoostDefault ? mhz : mBoostDefault);
+}
+
+void GpuBoostController::dump(int fd)
+{
+    if (!mArbiter) {
+        dprintf(fd, "gpu boost: off\n");
+        return;
+    }
+    dprintf(fd, "gpu boost: RPn=%dMHz RP0=%dMHz max=%dMHz min=%d boost=%d\n", mRpnMhz,
+            mRp0Mhz, mMaxMhz, mArbiter->value(mMinKnob),
+            mBoostKnob >= 0 ? mArbiter->value(mBoostKnob) : -1);
+}
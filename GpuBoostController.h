@@ -0,0 +1,60 @@
+/*
+ * Copyright (C) 2014 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_GPU_BOOST_CONTROLLER_H
+#define ANDROID_GPU_BOOST_CONTROLLER_H
+
+#include "BoostArbiter.h"
+#include "SysfsActuator.h"
+#include "SysfsNode.h"
+
+/**
+ * i915 render clock floor. A boost raises gt_min_freq_mhz, and
+ * gt_boost_freq_mhz with it, to a percentage of the RPn..RP0 range so
+ * the first frames of a gesture do not wait for the GPU to ramp up.
+ *
+ * Both nodes are arbiter knobs, keyed by the caller's requester id like
+ * the CPU boosts; callers hold and release from lease callbacks. When
+ * the last request ends both nodes return to their boot values.
+ */
+class GpuBoostController {
+
+  public:
+      GpuBoostController();
+      virtual ~GpuBoostController(){};
+      /* false unless card0 exposes the i915 RPS nodes */
+      bool probe();
+      bool active() const { return mArbiter != NULL; };
+      /* register the arbiter knobs; call before the actuator starts */
+      void attach(SysfsActuator *actuator, BoostArbiter *arbiter);
+      /* hold the floor at pct of the RPn..RP0 range; 0 releases */
+      void hold(int requester, int pct);
+      void dump(int fd);
+
+  private:
+      SysfsNode mMinNode;
+      SysfsNode mBoostNode;
+      BoostArbiter *mArbiter;
+      int mRpnMhz;
+      int mRp0Mhz;
+      /* gt_max_freq_mhz at probe; i915 rejects a min above it */
+      int mMaxMhz;
+      int mMinDefault;
+      int mBoostDefault;
+      int mMinKnob;
+      int mBoostKnob;
+};
+#endif  // ANDROID_GPU_BOOST_CONTROLLER_H
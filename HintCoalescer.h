@@ -0,0 +1,59 @@
+/*
+ * Copyright (C) 2014 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_HINT_COALESCER_H
+#define ANDROID_HINT_COALESCER_H
+
+#include <atomic>
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+ * Merges repeated actuations of one boost that arrive within a window
+ * into the first of them. Lock-free, so it can sit in front of a lease
+ * re-arm or a pulse write on the hint path; two racing callers may both
+ * pass, which only costs the actuation the window would have saved.
+ */
+class HintCoalescer {
+
+  public:
+      HintCoalescer(const char *name):
+          mName(name), mLastNs(0), mPassed(0), mMerged(0){};
+      /* true when the caller should actuate, false when merged */
+      bool pass(long long nowNs, long long windowNs) {
+          long long last = mLastNs.load(std::memory_order_relaxed);
+
+          if (windowNs > 0 && last && nowNs - last < windowNs) {
+              mMerged.fetch_add(1, std::memory_order_relaxed);
+              return false;
+          }
+          mLastNs.store(nowNs, std::memory_order_relaxed);
+          mPassed.fetch_add(1, std::memory_order_relaxed);
+          return true;
+      };
+      uint32_t merged() const { return mMerged.load(std::memory_order_relaxed); };
+      void dump(int fd) const {
+          dprintf(fd, "  %s: actuations=%u merged=%u\n", mName,
+                  mPassed.load(std::memory_order_relaxed), merged());
+      };
+
+  private:
+      const char *mName;
+      std::atomic<long long> mLastNs;
+      std::atomic<uint32_t> mPassed;
+      std::atomic<uint32_t> mMerged;
+};
+#endif  // ANDROID_HINT_COALESCER_H
@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 2014 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "HintRecorder.h"
+
+#include <stdio.h>
+#include <unistd.h>
+
+void HintRecorder::record(long long timeNs, uint32_t hint, uint32_t data)
+{
+    HintTraceRecord *r;
+
+    if (!mEnabled)
+        return;
+
+    r = &mRing[mHead.fetch_add(1, std::memory_order_relaxed) & (HINT_TRACE_RING_SIZE - 1)];
+    r->timeNs = timeNs;
+    r->hint = hint;
+    r->data = data;
+}
+
+int HintRecorder::save(int fd)
+{
+    HintTraceHeader header;
+    uint64_t head = mHead.load(std::memory_order_relaxed);
+    uint64_t first = head > HINT_TRACE_RING_SIZE ? head - HINT_TRACE_RING_SIZE : 0;
+    size_t start = first & (HINT_TRACE_RING_SIZE - 1);
+    size_t count = head - first;
+    size_t tail = count < HINT_TRACE_RING_SIZE - start ? count : HINT_TRACE_RING_SIZE - start;
+
+    header.magic = HINT_TRACE_MAGIC;
+    header.version = HINT_TRACE_VERSION;
+    header.recordSize = sizeof(HintTraceRecord);
+    header.count = count;
+    header.dropped = first;
+    if (write(fd, &header, sizeof(header)) != sizeof(header))
+        return -1;
+    /* the ring wraps at most once: [start, end) then [0, rest) */
+    if (write(fd, &mRing[start], tail * sizeof(HintTraceRecord)) < 0)
+        return -1;
+    if (count > tail && write(fd, mRing, (count - tail) * sizeof(HintTraceRecord)) < 0)
+        return -1;
+    return 0;
+}
+
+void HintRecorder::dump(int fd)
+{
+    dprintf(fd, "hint trace: enabled=%d recorded=%llu\n", mEnabled,
+            (unsigned long long)mHead.load(std::memory_order_relaxed));
+}
@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2014 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_HINT_RECORDER_H
+#define ANDROID_HINT_RECORDER_H
+
+#include <atomic>
+#include <stdint.h>
+
+#define HINT_TRACE_MAGIC 0x52544850 /* "PHTR" */
+#define HINT_TRACE_VERSION 1
+/* power of two; about two minutes of 60Hz vsync plus touch */
+#define HINT_TRACE_RING_SIZE 8192
+
+/*
+ * On-disk capture: one header followed by count records, oldest first.
+ * Fields are little endian as written by the device.
+ */
+struct HintTraceHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t recordSize;
+    uint32_t count;
+    /* records overwritten before the capture was saved */
+    uint32_t dropped;
+};
+
+struct HintTraceRecord {
+    int64_t timeNs;
+    uint32_t hint;
+    uint32_t data;
+};
+
+/**
+ * Fixed-size ring of timestamped hints. record() is a relaxed increment
+ * plus a 16 byte store, so it stays on the hint path when enabled; a
+ * save racing with hints may capture a torn last record.
+ */
+class HintRecorder {
+
+  private:
+      HintTraceRecord mRing[HINT_TRACE_RING_SIZE];
+      std::atomic<uint64_t> mHead;
+      bool mEnabled;
+
+  public:
+      HintRecorder():
+          mHead(0),
+          mEnabled(false){};
+      virtual ~HintRecorder(){};
+      void setEnabled(bool enabled) { mEnabled = enabled; };
+      bool enabled() const { return mEnabled; };
+      void record(long long timeNs, uint32_t hint, uint32_t data);
+      int save(int fd);
+      void dump(int fd);
+};
+#endif  // ANDROID_HINT_RECORDER_H
@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2014 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_LATENCY_HISTOGRAM_H
+#define ANDROID_LATENCY_HISTOGRAM_H
+
+#include <atomic>
+#include <stdint.h>
+#include <stdio.h>
+
+#define LATENCY_HISTOGRAM_BUCKETS 16
+#define LATENCY_UNIT_US 1000LL
+#define LATENCY_UNIT_MS 1000000LL
+
+/**
+ * Log2 histogram of durations. Bucket 0 holds samples below one unit,
+ * bucket i holds [2^(i-1), 2^i) units and the last bucket everything
+ * above. Recording is a couple of relaxed atomic adds so it can be used
+ * on the hint path.
+ */
+class LatencyHistogram {
+
+  public:
+      LatencyHistogram(const char *name, long long unitNs = LATENCY_UNIT_US):
+          mName(name), mUnitNs(unitNs), mSumNs(0), mMaxNs(0){
+          for (int i = 0; i < LATENCY_HISTOGRAM_BUCKETS; i++)
+              mBuckets[i].store(0, std::memory_order_relaxed);
+      };
+      void record(long long ns) {
+          long long units = ns / mUnitNs;
+          long long max = mMaxNs.load(std::memory_order_relaxed);
+          int i = 0;
+          while (units > 0 && i < LATENCY_HISTOGRAM_BUCKETS - 1) {
+              units >>= 1;
+              i++;
+          }
+          mBuckets[i].fetch_add(1, std::memory_order_relaxed);
+          mSumNs.fetch_add(ns, std::memory_order_relaxed);
+          while (ns > max && !mMaxNs.compare_exchange_weak(max, ns, std::memory_order_relaxed))
+              ;
+      };
+      uint32_t bucket(int i) const {
+          return mBuckets[i].load(std::memory_order_relaxed);
+      };
+      uint64_t count() const {
+          uint64_t total = 0;
+          for (int i = 0; i < LATENCY_HISTOGRAM_BUCKETS; i++)
+              total += bucket(i);
+          return total;
+      };
+      /* upper bound of bucket i in units, 0 for the overflow bucket */
+      static uint32_t bucketLimit(int i) {
+          return i < LATENCY_HISTOGRAM_BUCKETS - 1 ? 1u << i : 0;
+      };
+      const char *name() const { return mName; };
+      void dump(int fd) const {
+          const char *unit = mUnitNs == LATENCY_UNIT_MS ? "ms" : "us";
+          uint64_t n = count();
+          int i;
+
+          dprintf(fd, "  %s: count=%llu avg=%lld%s max=%lld%s\n    ", mName,
+                  (unsigned long long)n,
+                  n ? (long long)(mSumNs.load(std::memory_order_relaxed) / n / mUnitNs) : 0LL, unit,
+                  mMaxNs.load(std::memory_order_relaxed) / mUnitNs, unit);
+          for (i = 0; i < LATENCY_HISTOGRAM_BUCKETS; i++) {
+              if (!bucket(i))
+                  continue;
+              if (bucketLimit(i))
+                  dprintf(fd, " <%u%s:%u", bucketLimit(i), unit, bucket(i));
+              else
+                  dprintf(fd, " >=%u%s:%u", bucketLimit(i - 1), unit, bucket(i));
+          }
+          dprintf(fd, "\n");
+      };
+
+  private:
+      const char *mName;
+      long long mUnitNs;
+      std::atomic<uint32_t> mBuckets[LATENCY_HISTOGRAM_BUCKETS];
+      std::atomic<long long> mSumNs;
+      std::atomic<long long> mMaxNs;
+};
+#endif  // ANDROID_LATENCY_HISTOGRAM_H
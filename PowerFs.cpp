@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2014 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "PowerFs.h"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+/*
+ * Controllers are static objects that already read sysfs from their
+ * constructors, so the default backend is built on first use rather
+ * than by static initialization.
+ */
+static PowerFs *sFs = NULL;
+
+static PowerFs *default_fs(void)
+{
+    static PosixFs fs;
+
+    return &fs;
+}
+
+PowerFs *PowerFs::get()
+{
+    if (sFs == NULL)
+        sFs = default_fs();
+    return sFs;
+}
+
+void PowerFs::set(PowerFs *fs)
+{
+    sFs = fs ? fs : default_fs();
+}
+
+int PowerFs::readFile(const char *path, char *buf, size_t size)
+{
+    ssize_t ret;
+    int fd;
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return -1;
+
+    ret = pread(fd, buf, size - 1, 0);
+    close(fd);
+    if (ret <= 0)
+        return -1;
+    buf[ret] = '\0';
+    buf[strcspn(buf, "\n")] = '\0';
+    return 0;
+}
+
+int PosixFs::open(const char *path, int flags)
+{
+    return ::open(resolve(path).c_str(), flags | O_CLOEXEC);
+}
+
+int PosixFs::close(int fd)
+{
+    return ::close(fd);
+}
+
+ssize_t PosixFs::pread(int fd, void *buf, size_t len, off_t offset)
+{
+    return ::pread(fd, buf, len, offset);
+}
+
+ssize_t PosixFs::pwrite(int fd, const void *buf, size_t len, off_t offset)
+{
+    ssize_t ret = ::pwrite(fd, buf, len, offset);
+
+    /* a sysfs store replaces the value; emulate that on a tmpfs tree */
+    if (ret >= 0 && !mRoot.empty())
+        ftruncate(fd, offset + ret);
+    return ret;
+}
+
+int PosixFs::access(const char *path, int mode)
+{
+    return ::access(resolve(path).c_str(), mode);
+}
+
+int PosixFs::listDir(const char *path, std::vector<std::string> *names)
+{
+    DIR *dir;
+    struct dirent *de;
+
+    dir = opendir(resolve(path).c_str());
+    if (dir == NULL)
+        return -1;
+
+    names->clear();
+    while ((de = readdir(dir))) {
+        if (!strcmp(de->d_name, ".") || !strcmp(de->d_name, ".."))
+            continue;
+        names->push_back(de->d_name);
+    }
+    closedir(dir);
+    return 0;
+}
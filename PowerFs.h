@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2014 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_POWER_FS_H
+#define ANDROID_POWER_FS_H
+
+#include <string>
+#include <vector>
+
+#include <sys/types.h>
+
+/**
+ * Filesystem backend for every sysfs/cgroupfs access the HAL makes.
+ * The default forwards to the kernel; host benchmarks swap in a tmpfs
+ * root or an in-memory fake. Select the backend before power_init.
+ */
+class PowerFs {
+
+  public:
+      virtual ~PowerFs(){};
+      virtual int open(const char *path, int flags) = 0;
+      virtual int close(int fd) = 0;
+      virtual ssize_t pread(int fd, void *buf, size_t len, off_t offset) = 0;
+      virtual ssize_t pwrite(int fd, const void *buf, size_t len, off_t offset) = 0;
+      virtual int access(const char *path, int mode) = 0;
+      /* entry names of a directory, without "." and ".." */
+      virtual int listDir(const char *path, std::vector<std::string> *names) = 0;
+
+      /* read a whole small file, NUL terminated, trailing newline dropped */
+      int readFile(const char *path, char *buf, size_t size);
+
+      static PowerFs *get();
+      static void set(PowerFs *fs);
+};
+
+/**
+ * Kernel backed filesystem. An optional root is prepended to every
+ * path so a tmpfs tree can stand in for /sys and /dev/cpuset.
+ */
+class PosixFs : public PowerFs {
+
+  public:
+      PosixFs(const char *root = ""):
+          mRoot(root){};
+      virtual ~PosixFs(){};
+      virtual int open(const char *path, int flags);
+      virtual int close(int fd);
+      virtual ssize_t pread(int fd, void *buf, size_t len, off_t offset);
+      virtual ssize_t pwrite(int fd, const void *buf, size_t len, off_t offset);
+      virtual int access(const char *path, int mode);
+      virtual int listDir(const char *path, std::vector<std::string> *names);
+
+  private:
+      std::string mRoot;
+      std::string resolve(const char *path) { return mRoot + path; };
+};
+#endif  // ANDROID_POWER_FS_H
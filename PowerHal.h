@@ -0,0 +1,49 @@
+/*
+ * Copyright (C) 2014 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_POWER_HAL_H
+#define ANDROID_POWER_HAL_H
+
+#include <hardware/power.h>
+
+/*
+ * Entry points shared by the legacy power module and the AIDL service.
+ * Both front ends host the same controllers; the service calls in with
+ * the durations the framework passes instead of going through the hint
+ * heuristics.
+ */
+enum {
+    POWERHAL_MODE_LOW_POWER = 0,
+    POWERHAL_MODE_SUSTAINED_PERFORMANCE,
+    POWERHAL_MODE_VR,
+    POWERHAL_MODE_LAUNCH,
+};
+
+void powerhal_init(void);
+void powerhal_set_interactive(bool on);
+/* legacy hints, serialised on the module lock */
+void powerhal_hint(power_hint_t hint, void *data);
+void powerhal_set_mode(int mode, bool on);
+/*
+ * Timed boosts only arm leases and post to the actuator, so they never
+ * block on sysfs or on the module lock. durationNs <= 0 picks the
+ * tunable default.
+ */
+void powerhal_boost_interaction(long long durationNs);
+void powerhal_boost_display_update(void);
+void powerhal_boost_launch(long long durationNs);
+void powerhal_dump(int fd);
+#endif  // ANDROID_POWER_HAL_H
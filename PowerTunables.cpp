@@ -0,0 +1,250 @@
+/*
+ * Copyright (C) 2014 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "PowerHAL"
+
+#include "PowerTunables.h"
+
+#include <cutils/log.h>
+#include <cutils/properties.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifdef __BIONIC__
+#include <sys/system_properties.h>
+#endif
+
+static const char* POWER_HAL_TUNABLE_PROPERTY = "ro.powerhal.";
+static const char* POWER_HAL_TUNABLE_PROPERTY_DEBUG = "persist.powerhal."; /* for userdebug, eng build tuning*/
+
+#define NSEC_PER_MSEC 1000000LL
+
+/* value of ro.powerhal.<name>, or persist.powerhal.<name> on debug builds */
+static int tunable_get(const char *name, char *value)
+{
+    /* tunable names are longer than the legacy PROPERTY_KEY_MAX */
+    char prop[PROPERTY_VALUE_MAX];
+    int len = 0;
+
+#ifdef POWERHAL_DEBUG
+    snprintf(prop, sizeof(prop), "%s%s", POWER_HAL_TUNABLE_PROPERTY_DEBUG, name);
+    len = property_get(prop, value, NULL);
+#endif
+    if (len <= 0) {
+        snprintf(prop, sizeof(prop), "%s%s", POWER_HAL_TUNABLE_PROPERTY, name);
+        len = property_get(prop, value, NULL);
+    }
+    return len;
+}
+
+/* non-negative integer tunable; malformed values keep the default */
+static long long tunable_int(const char *name, long long def)
+{
+    char value[PROPERTY_VALUE_MAX];
+    char *end;
+    long long ret;
+
+    if (tunable_get(name, value) <= 0)
+        return def;
+    ret = strtoll(value, &end, 10);
+    if (end == value || *end != '\0' || ret < 0) {
+        ALOGW("Ignoring invalid value \"%s\" for tunable %s", value, name);
+        return def;
+    }
+    return ret;
+}
+
+/*
+ * Duration tunable in ms. Boost timers treat 0 as "never expires", so
+ * anything below 1ms keeps the default rather than pinning a boost.
+ */
+static long long tunable_ms(const char *name, long long def)
+{
+    long long ret = tunable_int(name, def);
+
+    if (ret < 1) {
+        ALOGW("Ignoring zero duration for tunable %s", name);
+        return def;
+    }
+    return ret;
+}
+
+PowerTunables::PowerTunables():
+    mSeq(0),
+    mReloads(0),
+    mWatching(false)
+{
+    pthread_mutex_init(&mLoadLock, NULL);
+    memset(&mCurrent, 0, sizeof(mCurrent));
+    /* built-in defaults until power_init loads the properties */
+    TouchClassifier::defaultParams(&mCurrent.touch);
+    mCurrent.touchBoost = CGROUP_BOOST_TOUCH;
+    mCurrent.touchBoostNs = CGROUP_BOOST_TOUCH_TIME_NS;
+    mCurrent.launchBoost = CGROUP_BOOST_LAUNCH;
+    mCurrent.sustainedBoost = CGROUP_BOOST_SUSTAINED;
+    mCurrent.gpuTouchBoost = GPU_BOOST_TOUCH;
+    mCurrent.gpuTouchBoostNs = GPU_BOOST_TOUCH_TIME_NS;
+    mCurrent.gpuLaunchBoost = GPU_BOOST_LAUNCH;
+    mCurrent.adaptiveMin = ADAPTIVE_BOOST_MIN;
+    mCurrent.adaptiveMax = ADAPTIVE_BOOST_MAX;
+    mCurrent.appLaunchTimeoutNs = APP_LAUNCH_BOOST_TIMEOUT_NS;
+    mCurrent.coalesceNs = HINT_COALESCE_TIME_NS;
+    mCurrent.screenOffCpusetNs = SCREEN_OFF_CPUSET_DELAY_NS;
+    mCurrent.screenOffDevicesNs = SCREEN_OFF_DEVICES_DELAY_NS;
+    mCurrent.screenOffCriticalNs = SCREEN_OFF_CRITICAL_DELAY_NS;
+}
+
+Tunables PowerTunables::get() const
+{
+    Tunables t;
+    unsigned int seq;
+
+    /* retry if a reload rewrote the block while we copied it */
+    do {
+        while ((seq = mSeq.load(std::memory_order_acquire)) & 1)
+            ;
+        memcpy(&t, &mCurrent, sizeof(t));
+        std::atomic_thread_fence(std::memory_order_acquire);
+    } while (mSeq.load(std::memory_order_relaxed) != seq);
+    return t;
+}
+
+bool PowerTunables::load()
+{
+    Tunables next;
+    Tunables *t = &next;
+    TouchParams def;
+
+    TouchClassifier::defaultParams(&def);
+    memset(t, 0, sizeof(*t));
+    t->touch.shortTouchMs = tunable_int("touch.short_ms", def.shortTouchMs);
+    t->touch.longTouchMs = tunable_int("touch.long_ms", def.longTouchMs);
+    t->touch.vsyncTouchMs = tunable_int("touch.vsync_touch_ms", def.vsyncTouchMs);
+    t->touch.vsyncBoostCount = tunable_int("touch.vsync_boost_count", def.vsyncBoostCount);
+    t->touch.scrollTouchCount = tunable_int("touch.scroll_touch_count", def.scrollTouchCount);
+    t->touch.scrollTimerCount = tunable_int("touch.scroll_timer_count", def.scrollTimerCount);
+    t->touch.predictive = tunable_int("touch.predictive", def.predictive) != 0;
+    t->touch.predictBaseBoostMs = tunable_ms("touch.predict_base_ms", def.predictBaseBoostMs);
+    t->touch.predictMaxBoostMs = tunable_ms("touch.predict_max_ms", def.predictMaxBoostMs);
+    t->touch.predictFlingTailMs = tunable_int("touch.predict_fling_ms", def.predictFlingTailMs);
+    /* the schedtune.* names predate uclamp and still set the touch boost */
+    t->touchBoost = tunable_int("boost.touch", tunable_int("schedtune.boost", CGROUP_BOOST_TOUCH));
+    t->touchBoostNs = tunable_ms("boost.touch_ms", tunable_ms("schedtune.boost_ms",
+                                  CGROUP_BOOST_TOUCH_TIME_NS / NSEC_PER_MSEC)) * NSEC_PER_MSEC;
+    t->launchBoost = tunable_int("boost.launch", CGROUP_BOOST_LAUNCH);
+    t->sustainedBoost = tunable_int("boost.sustained", CGROUP_BOOST_SUSTAINED);
+    t->gpuTouchBoost = tunable_int("gpu.touch", GPU_BOOST_TOUCH);
+    t->gpuTouchBoostNs = tunable_ms("gpu.touch_ms", GPU_BOOST_TOUCH_TIME_NS / NSEC_PER_MSEC) * NSEC_PER_MSEC;
+    t->gpuLaunchBoost = tunable_int("gpu.launch", GPU_BOOST_LAUNCH);
+    t->adaptiveBoost = tunable_int("adaptive.enable", 0) != 0;
+    t->adaptiveMin = tunable_int("adaptive.min", ADAPTIVE_BOOST_MIN);
+    t->adaptiveMax = tunable_int("adaptive.max", ADAPTIVE_BOOST_MAX);
+    t->appLaunchTimeoutNs = tunable_ms("launch.timeout_ms",
+                                       APP_LAUNCH_BOOST_TIMEOUT_NS / NSEC_PER_MSEC) * NSEC_PER_MSEC;
+    t->coalesceNs = tunable_int("hint.coalesce_ms", HINT_COALESCE_TIME_NS / NSEC_PER_MSEC) * NSEC_PER_MSEC;
+    t->screenOffCpusetNs = tunable_int("screen_off.cpuset_ms",
+                                       SCREEN_OFF_CPUSET_DELAY_NS / NSEC_PER_MSEC) * NSEC_PER_MSEC;
+    t->screenOffDevicesNs = tunable_int("screen_off.devices_ms",
+                                        SCREEN_OFF_DEVICES_DELAY_NS / NSEC_PER_MSEC) * NSEC_PER_MSEC;
+    t->screenOffCriticalNs = tunable_int("screen_off.critical_ms",
+                                         SCREEN_OFF_CRITICAL_DELAY_NS / NSEC_PER_MSEC) * NSEC_PER_MSEC;
+
+    pthread_mutex_lock(&mLoadLock);
+    /* memset above keeps padding equal, so the blocks compare bytewise */
+    if (!memcmp(t, &mCurrent, sizeof(*t))) {
+        pthread_mutex_unlock(&mLoadLock);
+        return false;
+    }
+    mSeq.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    memcpy(&mCurrent, t, sizeof(*t));
+    mSeq.fetch_add(1, std::memory_order_release);
+    pthread_mutex_unlock(&mLoadLock);
+
+    mReloads.fetch_add(1, std::memory_order_relaxed);
+    ALOGI("Tunables: short=%d long=%d vsync_touch=%d vsync_boost=%d scroll=%d/%d boost=%d/%lldms,%d,%d launch=%lldms",
+          t->touch.shortTouchMs, t->touch.longTouchMs, t->touch.vsyncTouchMs,
+          t->touch.vsyncBoostCount, t->touch.scrollTouchCount, t->touch.scrollTimerCount,
+          t->touchBoost, t->touchBoostNs / NSEC_PER_MSEC, t->launchBoost,
+          t->sustainedBoost, t->appLaunchTimeoutNs / NSEC_PER_MSEC);
+    return true;
+}
+
+void *PowerTunables::watcherLoop(void *arg)
+{
+#ifdef __BIONIC__
+    PowerTunables *self = (PowerTunables *)arg;
+    struct timespec debounce = {
+        TUNABLES_RELOAD_DEBOUNCE_MS / 1000,
+        (TUNABLES_RELOAD_DEBOUNCE_MS % 1000) * NSEC_PER_MSEC,
+    };
+    uint32_t serial = __system_property_area_serial();
+
+    /*
+     * Wakes on any property change. Wait for the burst to settle and
+     * reload once for all of it; load() filters out unrelated ones.
+     */
+    while (true) {
+        if (!__system_property_wait(NULL, serial, &serial, NULL))
+            continue;
+        nanosleep(&debounce, NULL);
+        serial = __system_property_area_serial();
+        self->load();
+    }
+#else
+    (void)arg;
+#endif
+    return NULL;
+}
+
+void PowerTunables::startWatcher()
+{
+#if defined(POWERHAL_DEBUG) && defined(__BIONIC__)
+    if (mWatching)
+        return;
+    if (pthread_create(&mWatcher, NULL, watcherLoop, this)) {
+        ALOGE("Could not start the tunables watcher");
+        return;
+    }
+    mWatching = true;
+#endif
+}
+
+void PowerTunables::dump(int fd)
+{
+    Tunables current = get();
+    const Tunables *t = &current;
+
+    dprintf(fd, "tunables: reloads=%u watching=%d\n",
+            mReloads.load(std::memory_order_relaxed), mWatching);
+    dprintf(fd, "  touch: short=%dms long=%dms vsync_touch=%dms vsync_boost_count=%d scroll=%d/%d\n",
+            t->touch.shortTouchMs, t->touch.longTouchMs, t->touch.vsyncTouchMs,
+            t->touch.vsyncBoostCount, t->touch.scrollTouchCount, t->touch.scrollTimerCount);
+    dprintf(fd, "  predictive=%d base=%dms max=%dms fling=%dms\n", t->touch.predictive,
+            t->touch.predictBaseBoostMs, t->touch.predictMaxBoostMs, t->touch.predictFlingTailMs);
+    dprintf(fd, "  cgroup boost: touch=%d for %lldms launch=%d sustained=%d\n", t->touchBoost,
+            t->touchBoostNs / NSEC_PER_MSEC, t->launchBoost, t->sustainedBoost);
+    dprintf(fd, "  gpu boost: touch=%d for %lldms launch=%d\n", t->gpuTouchBoost,
+            t->gpuTouchBoostNs / NSEC_PER_MSEC, t->gpuLaunchBoost);
+    dprintf(fd, "  adaptive boost: enabled=%d range=%d..%d\n", t->adaptiveBoost,
+            t->adaptiveMin, t->adaptiveMax);
+    dprintf(fd, "  app launch: timeout=%lldms\n", t->appLaunchTimeoutNs / NSEC_PER_MSEC);
+    dprintf(fd, "  hint coalescing: window=%lldms\n", t->coalesceNs / NSEC_PER_MSEC);
+    dprintf(fd, "  screen-off: cpuset=%lldms devices=%lldms critical=%lldms\n",
+            t->screenOffCpusetNs / NSEC_PER_MSEC, t->screenOffDevicesNs / NSEC_PER_MSEC,
+            t->screenOffCriticalNs / NSEC_PER_MSEC);
+}
@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2014 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_POWER_TUNABLES_H
+#define ANDROID_POWER_TUNABLES_H
+
+#include <atomic>
+#include <pthread.h>
+
+#include "TouchClassifier.h"
+
+/* foreground cgroup boost levels in percent, schedtune or uclamp.min */
+#define CGROUP_BOOST_TOUCH 40
+#define CGROUP_BOOST_TOUCH_TIME_NS 1000000000LL
+#define CGROUP_BOOST_LAUNCH 60
+#define CGROUP_BOOST_SUSTAINED 20
+/* i915 floor in percent of RPn..RP0 for the start of a gesture and a launch */
+#define GPU_BOOST_TOUCH 50
+#define GPU_BOOST_TOUCH_TIME_NS 250000000LL
+#define GPU_BOOST_LAUNCH 100
+/* range the adaptive touch boost moves in; the loop is off unless enabled */
+#define ADAPTIVE_BOOST_MIN 10
+#define ADAPTIVE_BOOST_MAX 100
+/* hard limit on an app launch boost whose end hint never arrives */
+#define APP_LAUNCH_BOOST_TIMEOUT_NS 5000000000LL
+/*
+ * Screen-off stages, as delays from the screen going off: cpuset and
+ * EPP first, then the non-critical devices, then display/input.
+ */
+#define SCREEN_OFF_CPUSET_DELAY_NS 1000000000LL
+#define SCREEN_OFF_DEVICES_DELAY_NS 3000000000LL
+#define SCREEN_OFF_CRITICAL_DELAY_NS 5000000000LL
+/* repeated boost actuations within this window are merged into one */
+#define HINT_COALESCE_TIME_NS 8000000LL
+/* property changes within this window are folded into one reload */
+#define TUNABLES_RELOAD_DEBOUNCE_MS 500
+
+struct Tunables {
+    TouchParams touch;
+    /* cgroup boost levels per lifecycle; 0 turns that boost off */
+    int touchBoost;
+    long long touchBoostNs;
+    int launchBoost;
+    int sustainedBoost;
+    /* GPU floor levels; 0 turns that boost off */
+    int gpuTouchBoost;
+    long long gpuTouchBoostNs;
+    int gpuLaunchBoost;
+    /* closed-loop touch level in adaptiveMin..adaptiveMax, if the device has PSI */
+    bool adaptiveBoost;
+    int adaptiveMin;
+    int adaptiveMax;
+    long long appLaunchTimeoutNs;
+    long long coalesceNs;
+    /* 0 for every stage restores the immediate screen-off */
+    long long screenOffCpusetNs;
+    long long screenOffDevicesNs;
+    long long screenOffCriticalNs;
+};
+
+/**
+ * Boost parameters loaded from ro.powerhal.<name>, overridden by
+ * persist.powerhal.<name> on debug builds. The block is published
+ * under a sequence count and get() hands out a copy, so the hint path
+ * reads a consistent block without locking and never holds a pointer
+ * a reload could rewrite. On debug builds a watcher thread reloads
+ * once system properties settle after a change.
+ */
+class PowerTunables {
+
+  private:
+      Tunables mCurrent;
+      /* odd while load() is rewriting mCurrent */
+      std::atomic<unsigned int> mSeq;
+      std::atomic<unsigned int> mReloads;
+      pthread_mutex_t mLoadLock;
+      pthread_t mWatcher;
+      bool mWatching;
+
+      static void *watcherLoop(void *arg);
+
+  public:
+      PowerTunables();
+      virtual ~PowerTunables(){};
+      /* returns true if the published values changed */
+      bool load();
+      void startWatcher();
+      Tunables get() const;
+      void dump(int fd);
+};
+#endif  // ANDROID_POWER_TUNABLES_H
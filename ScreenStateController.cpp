@@ -0,0 +1,184 @@
+/*
+ * Copyright (C) 2014 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "PowerHAL"
+
+#include "ScreenStateController.h"
+
+#include <cutils/log.h>
+#include <stdio.h>
+#include <time.h>
+
+#define NSEC_PER_SEC 1000000000LL
+
+static long long now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+}
+
+ScreenStateController::ScreenStateController():
+    mNumStages(0),
+    mResume(NULL),
+    mResumeArg(NULL),
+    mStarted(false),
+    mInteractive(true),
+    mOffTime(0),
+    mApplied(0),
+    mScreenOffs(0),
+    mResumeHist("screen_on_resume")
+{
+    pthread_condattr_t attr;
+
+    pthread_mutex_init(&mLock, NULL);
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&mCond, &attr);
+    pthread_condattr_destroy(&attr);
+}
+
+int ScreenStateController::addStage(const char *name, screen_stage_cb_t apply, void *arg)
+{
+    Stage *s;
+
+    if (mStarted || mNumStages >= SCREEN_MAX_STAGES) {
+        ALOGE("Cannot register screen-off stage %s", name);
+        return -1;
+    }
+    s = &mStages[mNumStages];
+    s->name = name;
+    s->apply = apply;
+    s->arg = arg;
+    s->delayNs = 0;
+    s->runs = 0;
+    s->cancels = 0;
+    return mNumStages++;
+}
+
+void ScreenStateController::setResume(screen_stage_cb_t resume, void *arg)
+{
+    mResume = resume;
+    mResumeArg = arg;
+}
+
+int ScreenStateController::start()
+{
+    if (mStarted)
+        return 0;
+    if (pthread_create(&mThread, NULL, threadLoop, this)) {
+        ALOGE("Could not start screen state thread, screen-off is not deferred");
+        return -1;
+    }
+    mStarted = true;
+    return 0;
+}
+
+/* called with mLock held */
+void ScreenStateController::runStage(Stage *s)
+{
+    ALOGV("Screen-off stage %s after %lld ms", s->name, (now_ns() - mOffTime) / 1000000LL);
+    s->apply(s->arg);
+    s->runs++;
+    mApplied++;
+}
+
+void ScreenStateController::screenOff(const long long *delaysNs)
+{
+    int i;
+
+    pthread_mutex_lock(&mLock);
+    if (!mInteractive) {
+        pthread_mutex_unlock(&mLock);
+        return;
+    }
+    mInteractive = false;
+    mOffTime = now_ns();
+    mScreenOffs++;
+    for (i = 0; i < mNumStages; i++)
+        mStages[i].delayNs = delaysNs[i];
+
+    /* without the thread nothing can wait, so fall back to the old immediate suspend */
+    if (!mStarted) {
+        while (mApplied < mNumStages)
+            runStage(&mStages[mApplied]);
+    }
+    pthread_cond_signal(&mCond);
+    pthread_mutex_unlock(&mLock);
+}
+
+void ScreenStateController::screenOn()
+{
+    long long start;
+
+    pthread_mutex_lock(&mLock);
+    if (mInteractive) {
+        pthread_mutex_unlock(&mLock);
+        return;
+    }
+    mInteractive = true;
+    if (mApplied < mNumStages)
+        mStages[mApplied].cancels++;
+    if (mApplied > 0 && mResume) {
+        start = now_ns();
+        mResume(mResumeArg);
+        mResumeHist.record(now_ns() - start);
+    }
+    mApplied = 0;
+    /* the thread may be sleeping towards a stage that is gone now */
+    pthread_cond_signal(&mCond);
+    pthread_mutex_unlock(&mLock);
+}
+
+void *ScreenStateController::threadLoop(void *arg)
+{
+    ScreenStateController *self = (ScreenStateController *)arg;
+    struct timespec ts;
+    long long deadline;
+
+    pthread_mutex_lock(&self->mLock);
+    while (1) {
+        if (self->mInteractive || self->mApplied >= self->mNumStages) {
+            pthread_cond_wait(&self->mCond, &self->mLock);
+            continue;
+        }
+
+        /* re-evaluated after every wake-up, so a screen-on in between wins */
+        deadline = self->mOffTime + self->mStages[self->mApplied].delayNs;
+        if (now_ns() < deadline) {
+            ts.tv_sec = deadline / NSEC_PER_SEC;
+            ts.tv_nsec = deadline % NSEC_PER_SEC;
+            pthread_cond_timedwait(&self->mCond, &self->mLock, &ts);
+            continue;
+        }
+        self->runStage(&self->mStages[self->mApplied]);
+    }
+    return NULL;
+}
+
+void ScreenStateController::dump(int fd)
+{
+    int i;
+
+    pthread_mutex_lock(&mLock);
+    dprintf(fd, "screen: interactive=%d stages run=%d/%d screen_offs=%u\n",
+            mInteractive, mApplied, mNumStages, mScreenOffs);
+    for (i = 0; i < mNumStages; i++)
+        dprintf(fd, "  %s: after=%lldms runs=%u cancelled=%u\n", mStages[i].name,
+                mStages[i].delayNs / 1000000LL, mStages[i].runs, mStages[i].cancels);
+    pthread_mutex_unlock(&mLock);
+    mResumeHist.dump(fd);
+}
@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2014 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_SCREEN_STATE_CONTROLLER_H
+#define ANDROID_SCREEN_STATE_CONTROLLER_H
+
+#include <pthread.h>
+
+#include "LatencyHistogram.h"
+
+#define SCREEN_MAX_STAGES 4
+
+typedef void (*screen_stage_cb_t)(void *arg);
+
+/**
+ * Staged, debounced screen-off. screenOff() only records the time; a
+ * worker thread then runs each stage once its delay since screen-off
+ * has passed, in the order the stages were added. screenOn() drops the
+ * stages still pending, so a screen that comes back within the first
+ * delay costs nothing, and runs the resume callback only if some stage
+ * already ran.
+ *
+ * Stages and the resume callback run with the controller lock held, so
+ * a resume always waits for a stage in progress and never overlaps it.
+ */
+class ScreenStateController {
+
+  public:
+      ScreenStateController();
+      virtual ~ScreenStateController(){};
+      /* Stages must be registered before start() */
+      int addStage(const char *name, screen_stage_cb_t apply, void *arg);
+      void setResume(screen_stage_cb_t resume, void *arg);
+      int start();
+      /* delaysNs[i] is the time from screen-off until stage i runs */
+      void screenOff(const long long *delaysNs);
+      void screenOn();
+      void dump(int fd);
+
+  private:
+      struct Stage {
+          const char *name;
+          screen_stage_cb_t apply;
+          void *arg;
+          long long delayNs;
+          unsigned int runs;
+          /* screen-ons that arrived while this was the next stage */
+          unsigned int cancels;
+      };
+
+      Stage mStages[SCREEN_MAX_STAGES];
+      int mNumStages;
+      screen_stage_cb_t mResume;
+      void *mResumeArg;
+      pthread_mutex_t mLock;
+      pthread_cond_t mCond;
+      pthread_t mThread;
+      bool mStarted;
+      bool mInteractive;
+      long long mOffTime;
+      /* stages run since the last screen-off */
+      int mApplied;
+      unsigned int mScreenOffs;
+      LatencyHistogram mResumeHist;
+
+      void runStage(Stage *s);
+      static void *threadLoop(void *arg);
+};
+#endif  // ANDROID_SCREEN_STATE_CONTROLLER_H
@@ -0,0 +1,292 @@
+/*
+ * Copyright (C) 2014 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "PowerHAL"
+
+#include "SustainedController.h"
+#include "PowerFs.h"
+
+#include <cutils/log.h>
+#include <cutils/properties.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <vector>
+
+static const char* THERMAL_DIR = "/sys/class/thermal";
+static const char* POWER_HAL_SUSTAINED_TARGET_PROPERTY = "ro.powerhal.sustained.target_mc";
+static const char* POWER_HAL_SUSTAINED_TARGET_PROPERTY_DEBUG = "persist.powerhal.sustained.target_mc"; /* for userdebug, eng build tuning*/
+
+/* zone types that track the CPU package, best first */
+static const char* CPU_ZONE_TYPES[] = {
+    "x86_pkg_temp",
+    "TCPU",
+    "B0D4",
+    "CPU",
+};
+
+#define NSEC_PER_SEC 1000000000LL
+#define NSEC_PER_MSEC 1000000LL
+#define MAX_TRIPS 16
+
+static long long now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+}
+
+SustainedController::SustainedController():
+    mTargetMc(SUSTAINED_DEFAULT_TARGET_MC),
+    mCapCb(NULL),
+    mCapArg(NULL),
+    mRunning(false),
+    mCapPct(100),
+    mLastTempMc(0),
+    mAdjustments(0),
+    mStarted(false),
+    mSessionHist("sustained_session", LATENCY_UNIT_MS),
+    mSessionStart(0)
+{
+    pthread_condattr_t attr;
+
+    memset(mRequests, 0, sizeof(mRequests));
+    pthread_mutex_init(&mLock, NULL);
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&mCond, &attr);
+    pthread_condattr_destroy(&attr);
+}
+
+bool SustainedController::probe()
+{
+    PowerFs *fs = PowerFs::get();
+    std::vector<std::string> zones;
+    char path[PATH_MAX];
+    char buf[32];
+    int best = -1;
+    size_t i, t;
+    int trip;
+
+    if (fs->listDir(THERMAL_DIR, &zones))
+        return false;
+    for (i = 0; i < zones.size(); i++) {
+        if (zones[i].compare(0, 12, "thermal_zone"))
+            continue;
+        snprintf(path, sizeof(path), "%s/%s/type", THERMAL_DIR, zones[i].c_str());
+        if (fs->readFile(path, buf, sizeof(buf)))
+            continue;
+        for (t = 0; t < sizeof(CPU_ZONE_TYPES) / sizeof(CPU_ZONE_TYPES[0]); t++) {
+            if (strcmp(buf, CPU_ZONE_TYPES[t]) || (best >= 0 && (int)t >= best))
+                continue;
+            best = t;
+            mZonePath = std::string(THERMAL_DIR) + "/" + zones[i];
+        }
+    }
+    if (best < 0) {
+        ALOGW("No CPU thermal zone, sustained mode keeps its start cap");
+        return false;
+    }
+
+    /* target: configured, else just below the first passive trip */
+    mTargetMc = 0;
+#ifdef POWERHAL_DEBUG
+    mTargetMc = property_get_int32(POWER_HAL_SUSTAINED_TARGET_PROPERTY_DEBUG, 0);
+#endif
+    if (mTargetMc <= 0)
+        mTargetMc = property_get_int32(POWER_HAL_SUSTAINED_TARGET_PROPERTY, 0);
+    for (trip = 0; mTargetMc <= 0 && trip < MAX_TRIPS; trip++) {
+        snprintf(path, sizeof(path), "%s/trip_point_%d_type", mZonePath.c_str(), trip);
+        if (fs->readFile(path, buf, sizeof(buf)))
+            break;
+        if (strcmp(buf, "passive"))
+            continue;
+        snprintf(path, sizeof(path), "%s/trip_point_%d_temp", mZonePath.c_str(), trip);
+        if (!fs->readFile(path, buf, sizeof(buf)) && atoi(buf) > SUSTAINED_TRIP_MARGIN_MC)
+            mTargetMc = atoi(buf) - SUSTAINED_TRIP_MARGIN_MC;
+    }
+    if (mTargetMc <= 0)
+        mTargetMc = SUSTAINED_DEFAULT_TARGET_MC;
+
+    ALOGI("Sustained mode follows %s, target %d mC", mZonePath.c_str(), mTargetMc);
+    return true;
+}
+
+void SustainedController::setCapCallback(sustained_cap_cb_t cb, void *arg)
+{
+    mCapCb = cb;
+    mCapArg = arg;
+}
+
+int SustainedController::start()
+{
+    if (mStarted)
+        return 0;
+    if (pthread_create(&mThread, NULL, threadLoop, this)) {
+        ALOGE("Could not start the sustained performance loop");
+        return -1;
+    }
+    mStarted = true;
+    return 0;
+}
+
+int SustainedController::readTemp()
+{
+    char path[PATH_MAX];
+    char buf[32];
+
+    if (mZonePath.empty())
+        return -1;
+    snprintf(path, sizeof(path), "%s/temp", mZonePath.c_str());
+    if (PowerFs::get()->readFile(path, buf, sizeof(buf)))
+        return -1;
+    return atoi(buf);
+}
+
+/* one control step; returns the new cap */
+int SustainedController::step(int tempMc)
+{
+    int error = mTargetMc - tempMc;
+    int delta;
+
+    if (tempMc < 0 || (error < SUSTAINED_DEADBAND_MC && error > -SUSTAINED_DEADBAND_MC))
+        return mCapPct;
+
+    /* one percent per degree off target, bounded so frame time moves slowly */
+    delta = error / 1000;
+    if (delta > SUSTAINED_MAX_STEP_PCT)
+        delta = SUSTAINED_MAX_STEP_PCT;
+    if (delta < -SUSTAINED_MAX_STEP_PCT)
+        delta = -SUSTAINED_MAX_STEP_PCT;
+
+    delta += mCapPct;
+    if (delta > 100)
+        delta = 100;
+    if (delta < SUSTAINED_MIN_CAP_PCT)
+        delta = SUSTAINED_MIN_CAP_PCT;
+    return delta;
+}
+
+void *SustainedController::threadLoop(void *arg)
+{
+    SustainedController *self = (SustainedController *)arg;
+    struct timespec deadline;
+    long long next;
+    int applied = 100;
+    int cap;
+    int temp;
+
+    pthread_mutex_lock(&self->mLock);
+    while (1) {
+        if (!self->mRunning) {
+            if (applied != 100 && self->mCapCb) {
+                applied = 100;
+                pthread_mutex_unlock(&self->mLock);
+                self->mCapCb(100, self->mCapArg);
+                pthread_mutex_lock(&self->mLock);
+                continue;
+            }
+            pthread_cond_wait(&self->mCond, &self->mLock);
+            continue;
+        }
+
+        pthread_mutex_unlock(&self->mLock);
+        temp = self->readTemp();
+        pthread_mutex_lock(&self->mLock);
+        if (!self->mRunning)
+            continue;
+
+        self->mLastTempMc = temp;
+        cap = self->step(temp);
+        if (cap != self->mCapPct)
+            self->mAdjustments++;
+        self->mCapPct = cap;
+        if (cap != applied && self->mCapCb) {
+            applied = cap;
+            pthread_mutex_unlock(&self->mLock);
+            self->mCapCb(cap, self->mCapArg);
+            pthread_mutex_lock(&self->mLock);
+        }
+
+        /* sleep a period, or until the mode is dropped */
+        next = now_ns() + SUSTAINED_PERIOD_MS * NSEC_PER_MSEC;
+        deadline.tv_sec = next / NSEC_PER_SEC;
+        deadline.tv_nsec = next % NSEC_PER_SEC;
+        while (self->mRunning && pthread_cond_timedwait(&self->mCond, &self->mLock, &deadline) == 0)
+            ;
+    }
+    pthread_mutex_unlock(&self->mLock);
+    return NULL;
+}
+
+void SustainedController::request(int source, bool active)
+{
+    bool running;
+    int i;
+
+    if (source < 0 || source >= NUM_SOURCES)
+        return;
+
+    pthread_mutex_lock(&mLock);
+    mRequests[source] = active;
+    running = false;
+    for (i = 0; i < NUM_SOURCES; i++)
+        running |= mRequests[i];
+    if (running != mRunning) {
+        mRunning = running;
+        if (running) {
+            mCapPct = SUSTAINED_START_CAP_PCT;
+            mSessionStart = now_ns();
+        } else {
+            mCapPct = 100;
+            mSessionHist.record(now_ns() - mSessionStart);
+        }
+        pthread_cond_signal(&mCond);
+    }
+    pthread_mutex_unlock(&mLock);
+}
+
+bool SustainedController::active()
+{
+    bool running;
+
+    pthread_mutex_lock(&mLock);
+    running = mRunning;
+    pthread_mutex_unlock(&mLock);
+    return running;
+}
+
+int SustainedController::cap()
+{
+    int cap;
+
+    pthread_mutex_lock(&mLock);
+    cap = mCapPct;
+    pthread_mutex_unlock(&mLock);
+    return cap;
+}
+
+void SustainedController::dump(int fd)
+{
+    pthread_mutex_lock(&mLock);
+    dprintf(fd, "sustained: zone=%s target=%dmC running=%d (sustained=%d vr=%d) cap=%d%% temp=%dmC adjustments=%u\n",
+            mZonePath.empty() ? "none" : mZonePath.c_str(), mTargetMc, mRunning,
+            mRequests[SOURCE_SUSTAINED], mRequests[SOURCE_VR], mCapPct, mLastTempMc, mAdjustments);
+    pthread_mutex_unlock(&mLock);
+    mSessionHist.dump(fd);
+}
@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2014 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_SUSTAINED_CONTROLLER_H
+#define ANDROID_SUSTAINED_CONTROLLER_H
+
+#include <pthread.h>
+#include <string>
+
+#include "LatencyHistogram.h"
+
+/* control loop period while sustained or VR mode is active */
+#define SUSTAINED_PERIOD_MS 1000
+/* no cap adjustment within this band around the target (milli-C) */
+#define SUSTAINED_DEADBAND_MC 1000
+/* largest cap change per period, in percent of the frequency range */
+#define SUSTAINED_MAX_STEP_PCT 2
+#define SUSTAINED_MIN_CAP_PCT 40
+/* cap the loop starts from, before any thermal feedback */
+#define SUSTAINED_START_CAP_PCT 80
+/* target below the first passive trip point when none is configured */
+#define SUSTAINED_TRIP_MARGIN_MC 5000
+#define SUSTAINED_DEFAULT_TARGET_MC 85000
+
+typedef void (*sustained_cap_cb_t)(int capPct, void *arg);
+
+/**
+ * Holds the CPU at a frequency cap its thermals can sustain instead of
+ * boosting into throttling. While sustained performance or VR mode is
+ * requested, a background loop reads the CPU thermal zone once per
+ * period and moves the cap a few percent towards the temperature target;
+ * small steps and a deadband keep frame times steady.
+ */
+class SustainedController {
+
+  public:
+      enum {
+          SOURCE_SUSTAINED = 0,
+          SOURCE_VR,
+          NUM_SOURCES
+      };
+
+      SustainedController();
+      virtual ~SustainedController(){};
+      /* pick the thermal zone and target; false if there is no zone */
+      bool probe();
+      /* cap changes are handed to cb from the loop thread; 100 lifts the cap */
+      void setCapCallback(sustained_cap_cb_t cb, void *arg);
+      int start();
+      void request(int source, bool active);
+      bool active();
+      int cap();
+      void dump(int fd);
+
+  private:
+      std::string mZonePath;
+      int mTargetMc;
+      sustained_cap_cb_t mCapCb;
+      void *mCapArg;
+      bool mRequests[NUM_SOURCES];
+      bool mRunning;
+      int mCapPct;
+      int mLastTempMc;
+      unsigned int mAdjustments;
+      pthread_mutex_t mLock;
+      pthread_cond_t mCond;
+      pthread_t mThread;
+      bool mStarted;
+      LatencyHistogram mSessionHist;
+      long long mSessionStart;
+
+      int readTemp();
+      int step(int tempMc);
+      static void *threadLoop(void *arg);
+};
+#endif  // ANDROID_SUSTAINED_CONTROLLER_H
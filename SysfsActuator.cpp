@@ -0,0 +1,268 @@
+/*
+ * Copyright (C) 2014 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "PowerHAL"
+
+#include "SysfsActuator.h"
+
+#include <cutils/log.h>
+#include <errno.h>
+#include <linux/futex.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+static_assert(ACTUATOR_RING_SIZE >= ACTUATOR_MAX_NODES, "a queued node must always find a ring slot");
+
+static int futex(std::atomic<int> *addr, int op, int val)
+{
+    return syscall(__NR_futex, reinterpret_cast<int *>(addr), op, val, NULL, NULL, 0);
+}
+
+SysfsActuator::SysfsActuator():
+    mEnqueuePos(0),
+    mDequeuePos(0),
+    mParked(0),
+    mDropped(0),
+    mPosted(0),
+    mCollapsed(0),
+    mDroppedTotal(0),
+    mWriteHist("actuator_write"),
+    mNumNodes(0),
+    mStarted(false),
+    mSynchronous(false)
+{
+    for (size_t i = 0; i < ACTUATOR_RING_SIZE; i++)
+        mRing[i].seq.store(i, std::memory_order_relaxed);
+}
+
+int SysfsActuator::addNode(SysfsNode *node, bool pulse)
+{
+    Node *n;
+
+    if (mStarted || mNumNodes >= ACTUATOR_MAX_NODES) {
+        ALOGE("Cannot register %s with the actuator", node->path());
+        return -1;
+    }
+
+    n = &mNodes[mNumNodes];
+    n->node = node;
+    n->pulse = pulse;
+    n->queued.store(false, std::memory_order_relaxed);
+    n->slotLock.clear(std::memory_order_relaxed);
+    n->desired[0] = '\0';
+    n->pending[0] = '\0';
+    n->applied[0] = '\0';
+    return mNumNodes++;
+}
+
+int SysfsActuator::start()
+{
+    char buf[80];
+    int ret;
+
+    if (mStarted)
+        return 0;
+
+    ret = pthread_create(&mThread, NULL, threadLoop, this);
+    if (ret) {
+        strerror_r(ret, buf, sizeof(buf));
+        ALOGE("Could not start actuator thread: %s", buf);
+        return -1;
+    }
+    mStarted = true;
+    return 0;
+}
+
+bool SysfsActuator::post(int id, const char *value)
+{
+    Node *n;
+
+    if (id < 0 || id >= mNumNodes)
+        return false;
+
+    n = &mNodes[id];
+    mPosted.fetch_add(1, std::memory_order_relaxed);
+    if (!mStarted || mSynchronous) {
+        n->node->write(value);
+        return true;
+    }
+
+    /* the latest value wins; the slot is never left behind by the ring */
+    while (n->slotLock.test_and_set(std::memory_order_acquire))
+        ;
+    snprintf(n->desired, sizeof(n->desired), "%s", value);
+    n->slotLock.clear(std::memory_order_release);
+
+    if (n->queued.exchange(true, std::memory_order_acq_rel)) {
+        mCollapsed.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+    if (!enqueue(id)) {
+        /* cannot happen while the ring holds every node */
+        n->queued.store(false, std::memory_order_release);
+        mDropped.fetch_add(1, std::memory_order_relaxed);
+        mDroppedTotal.fetch_add(1, std::memory_order_relaxed);
+    }
+    wake();
+    return true;
+}
+
+/* Bounded MPSC ring of node indices: claim a slot, fill it, then publish it */
+bool SysfsActuator::enqueue(int id)
+{
+    Cell *cell;
+    size_t pos;
+
+    pos = mEnqueuePos.load(std::memory_order_relaxed);
+    while (1) {
+        cell = &mRing[pos & (ACTUATOR_RING_SIZE - 1)];
+        size_t seq = cell->seq.load(std::memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+        if (diff == 0) {
+            if (mEnqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                break;
+        } else if (diff < 0) {
+            return false;
+        } else {
+            pos = mEnqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    cell->id = id;
+    cell->seq.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+void SysfsActuator::wake()
+{
+    /* Pairs with the fence in threadLoop() before it re-checks the ring */
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (mParked.load(std::memory_order_relaxed)) {
+        mParked.store(0, std::memory_order_relaxed);
+        futex(&mParked, FUTEX_WAKE_PRIVATE, 1);
+    }
+}
+
+bool SysfsActuator::dequeue(int *id)
+{
+    Cell *cell = &mRing[mDequeuePos & (ACTUATOR_RING_SIZE - 1)];
+    size_t seq = cell->seq.load(std::memory_order_acquire);
+
+    if (seq != mDequeuePos + 1)
+        return false;
+
+    *id = cell->id;
+    cell->seq.store(mDequeuePos + ACTUATOR_RING_SIZE, std::memory_order_release);
+    mDequeuePos++;
+    return true;
+}
+
+bool SysfsActuator::empty()
+{
+    Cell *cell = &mRing[mDequeuePos & (ACTUATOR_RING_SIZE - 1)];
+    return cell->seq.load(std::memory_order_acquire) != mDequeuePos + 1;
+}
+
+/* false if the write failed */
+bool SysfsActuator::apply(Node *n)
+{
+    struct timespec start, end;
+    int ret;
+
+    if (!n->pulse && !strcmp(n->pending, n->applied)) {
+        mCollapsed.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    ret = n->node->write(n->pending);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    mWriteHist.record((end.tv_sec - start.tv_sec) * 1000000000LL + (end.tv_nsec - start.tv_nsec));
+
+    if (!ret)
+        snprintf(n->applied, sizeof(n->applied), "%s", n->pending);
+    else
+        n->applied[0] = '\0';
+    return !ret;
+}
+
+void *SysfsActuator::threadLoop(void *arg)
+{
+    SysfsActuator *self = (SysfsActuator *)arg;
+    int failed[ACTUATOR_MAX_NODES];
+    unsigned int dropped;
+    int numFailed;
+    Node *n;
+    int id;
+    int i;
+
+    while (1) {
+        numFailed = 0;
+        while (self->dequeue(&id)) {
+            n = &self->mNodes[id];
+            /* unqueue before the copy, so a later post queues the node again */
+            n->queued.store(false, std::memory_order_seq_cst);
+            while (n->slotLock.test_and_set(std::memory_order_acquire))
+                ;
+            snprintf(n->pending, sizeof(n->pending), "%s", n->desired);
+            n->slotLock.clear(std::memory_order_release);
+            if (!self->apply(n) && numFailed < ACTUATOR_MAX_NODES)
+                failed[numFailed++] = id;
+        }
+
+        /*
+         * Writes go out in post order, but a node that was still queued
+         * keeps its earlier place. A write its sibling had to precede
+         * (cpufreq min/max) gets one more try once the rest has landed.
+         */
+        for (i = 0; i < numFailed; i++)
+            self->apply(&self->mNodes[failed[i]]);
+
+        dropped = self->mDropped.exchange(0, std::memory_order_relaxed);
+        if (dropped)
+            ALOGW("Actuator ring overflow, %u commands dropped", dropped);
+
+        self->mParked.store(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!self->empty()) {
+            self->mParked.store(0, std::memory_order_relaxed);
+            continue;
+        }
+        futex(&self->mParked, FUTEX_WAIT_PRIVATE, 1);
+        self->mParked.store(0, std::memory_order_relaxed);
+    }
+    return NULL;
+}
+
+void SysfsActuator::dump(int fd)
+{
+    int i;
+
+    dprintf(fd, "actuator: posted=%u collapsed=%u dropped=%u%s\n",
+            mPosted.load(std::memory_order_relaxed),
+            mCollapsed.load(std::memory_order_relaxed),
+            mDroppedTotal.load(std::memory_order_relaxed),
+            mSynchronous ? " (synchronous)" : "");
+    mWriteHist.dump(fd);
+    for (i = 0; i < mNumNodes; i++) {
+        SysfsNode *node = mNodes[i].node;
+        dprintf(fd, "  node %s: writes=%u errors=%u\n", node->path(),
+                node->writes(), node->writeErrors());
+    }
+}
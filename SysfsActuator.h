@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2014 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_SYSFS_ACTUATOR_H
+#define ANDROID_SYSFS_ACTUATOR_H
+
+#include <atomic>
+#include <pthread.h>
+#include <stddef.h>
+
+#include "LatencyHistogram.h"
+#include "SysfsNode.h"
+
+/* boost and cpuset nodes plus three HWP nodes per cpufreq policy */
+#define ACTUATOR_MAX_NODES 224
+/* large enough for cpuset lists */
+#define ACTUATOR_VALUE_MAX 64
+/* must be a power of two and hold every node at once */
+#define ACTUATOR_RING_SIZE 256
+
+/**
+ * Single consumer thread that owns all blocking sysfs writes issued from
+ * the hint path. Producers store the desired value in the node's own
+ * slot and, unless the node is already queued, push its index into a
+ * bounded MPSC ring; the actuator drains the ring and writes each queued
+ * node's latest value once. A node is in the ring at most once and the
+ * ring holds every node, so a post is never lost, however far behind
+ * the actuator is: the last value posted for a node is always written.
+ *
+ * Level nodes (e.g. min_perf_pct) are not rewritten when the desired value
+ * matches what was last applied. Pulse nodes (e.g. touchboostpulse) are
+ * written once per drain, however many pulses were posted.
+ */
+class SysfsActuator {
+
+  public:
+      SysfsActuator();
+      virtual ~SysfsActuator(){};
+      /* Nodes must be registered before start() */
+      int addNode(SysfsNode *node, bool pulse);
+      int start();
+      /* Never blocks on sysfs; false only for an unknown node */
+      bool post(int id, const char *value);
+      /* Debug: bypass the thread and write on the caller's thread */
+      void setSynchronous(bool sync) { mSynchronous = sync; };
+      void dump(int fd);
+
+  private:
+      struct Cell {
+          std::atomic<size_t> seq;
+          int id;
+      };
+      struct Node {
+          SysfsNode *node;
+          bool pulse;
+          /* set while the node's index is in the ring */
+          std::atomic<bool> queued;
+          /* guards desired; held only for the copy in and out */
+          std::atomic_flag slotLock;
+          char desired[ACTUATOR_VALUE_MAX];
+          /* actuator thread only */
+          char pending[ACTUATOR_VALUE_MAX];
+          char applied[ACTUATOR_VALUE_MAX];
+      };
+
+      Cell mRing[ACTUATOR_RING_SIZE];
+      std::atomic<size_t> mEnqueuePos;
+      size_t mDequeuePos;
+      /* futex word: 1 while the actuator is parked waiting for work */
+      std::atomic<int> mParked;
+      std::atomic<unsigned int> mDropped;
+      std::atomic<uint32_t> mPosted;
+      std::atomic<uint32_t> mCollapsed;
+      std::atomic<uint32_t> mDroppedTotal;
+      LatencyHistogram mWriteHist;
+      Node mNodes[ACTUATOR_MAX_NODES];
+      int mNumNodes;
+      bool mStarted;
+      bool mSynchronous;
+      pthread_t mThread;
+
+      bool enqueue(int id);
+      bool dequeue(int *id);
+      bool empty();
+      bool apply(Node *n);
+      void wake();
+      static void *threadLoop(void *arg);
+};
+#endif  // ANDROID_SYSFS_ACTUATOR_H
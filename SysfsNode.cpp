@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2014 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "PowerHAL"
+
+#include "SysfsNode.h"
+#include "PowerFs.h"
+
+#include <cutils/log.h>
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+
+SysfsNode::~SysfsNode()
+{
+    close();
+}
+
+int SysfsNode::open()
+{
+    char buf[80];
+
+    if (mFd >= 0)
+        return 0;
+
+    mFd = PowerFs::get()->open(mPath.c_str(), mFlags);
+    if (mFd < 0) {
+        strerror_r(errno, buf, sizeof(buf));
+        ALOGE("Error opening %s: %s\n", mPath.c_str(), buf);
+        return -1;
+    }
+    return 0;
+}
+
+void SysfsNode::close()
+{
+    if (mFd >= 0) {
+        PowerFs::get()->close(mFd);
+        mFd = -1;
+    }
+}
+
+int SysfsNode::write(const char *s, size_t len)
+{
+    char buf[80];
+    ssize_t ret;
+
+    mWrites.fetch_add(1, std::memory_order_relaxed);
+    if (open()) {
+        mWriteErrors.fetch_add(1, std::memory_order_relaxed);
+        return -1;
+    }
+
+    ret = PowerFs::get()->pwrite(mFd, s, len, 0);
+    if (ret < 0 && (errno == ENODEV || errno == EBADF)) {
+        /* The node went away under us (e.g. driver rebind); reopen once */
+        close();
+        if (open()) {
+            mWriteErrors.fetch_add(1, std::memory_order_relaxed);
+            return -1;
+        }
+        ret = PowerFs::get()->pwrite(mFd, s, len, 0);
+    }
+
+    if (ret < 0) {
+        mWriteErrors.fetch_add(1, std::memory_order_relaxed);
+        strerror_r(errno, buf, sizeof(buf));
+        ALOGE("Error writing to %s: %s\n", mPath.c_str(), buf);
+        return -1;
+    }
+    return 0;
+}
+
+int SysfsNode::write(const char *s)
+{
+    return write(s, strlen(s));
+}
+
+int SysfsNode::read(char *s, size_t len)
+{
+    char buf[80];
+    ssize_t ret;
+
+    if (open())
+        return -1;
+
+    ret = PowerFs::get()->pread(mFd, s, len, 0);
+    if (ret < 0 && (errno == ENODEV || errno == EBADF)) {
+        close();
+        if (open())
+            return -1;
+        ret = PowerFs::get()->pread(mFd, s, len, 0);
+    }
+
+    if (ret < 0) {
+        strerror_r(errno, buf, sizeof(buf));
+        ALOGE("Error reading from %s: %s\n", mPath.c_str(), buf);
+        return -1;
+    }
+    return ret;
+}
@@ -0,0 +1,54 @@
+/*
+ * Copyright (C) 2014 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_SYSFS_NODE_H
+#define ANDROID_SYSFS_NODE_H
+
+#include <atomic>
+#include <string>
+
+#include <sys/types.h>
+#include <fcntl.h>
+
+/**
+ * A sysfs/cgroupfs attribute that is opened once and kept open.
+ * Writes go through pwrite() at offset 0; the node is only reopened
+ * when the kernel tells us the fd went stale (ENODEV/EBADF).
+ */
+class SysfsNode {
+
+  public:
+      SysfsNode(const char *path, int flags = O_WRONLY):
+          mPath(path), mFlags(flags), mFd(-1), mWrites(0), mWriteErrors(0){};
+      virtual ~SysfsNode();
+      int open();
+      void close();
+      int write(const char *s, size_t len);
+      int write(const char *s);
+      int read(char *s, size_t len);
+      bool isOpen() const { return mFd >= 0; };
+      const char *path() const { return mPath.c_str(); };
+      uint32_t writes() const { return mWrites.load(std::memory_order_relaxed); };
+      uint32_t writeErrors() const { return mWriteErrors.load(std::memory_order_relaxed); };
+
+  private:
+      std::string mPath;
+      int mFlags;
+      int mFd;
+      std::atomic<uint32_t> mWrites;
+      std::atomic<uint32_t> mWriteErrors;
+};
+#endif  // ANDROID_SYSFS_NODE_H
@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2014 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "TouchClassifier.h"
+
+#define NSEC_PER_MSEC 1000000.0
+
+TouchClassifier::TouchClassifier()
+{
+    defaultParams(&mParams);
+    reset();
+}
+
+void TouchClassifier::defaultParams(TouchParams *params)
+{
+    params->shortTouchMs = SHORT_TOUCH_TIME;
+    params->longTouchMs = LONG_TOUCH_TIME;
+    params->vsyncTouchMs = VSYNC_TOUCH_TIME;
+    params->vsyncBoostCount = VSYNC_BOOST_COUNT;
+    params->scrollTouchCount = SCROLL_TOUCH_COUNT;
+    params->scrollTimerCount = SCROLL_TIMER_COUNT;
+    params->predictive = 0;
+    params->predictBaseBoostMs = PREDICT_BASE_BOOST_MS;
+    params->predictMaxBoostMs = PREDICT_MAX_BOOST_MS;
+    params->predictFlingTailMs = PREDICT_FLING_TAIL_MS;
+}
+
+void TouchClassifier::reset()
+{
+    mPrevTouchNs = 0;
+    mLastTouchNs = 0;
+    mConsecutiveTouch = 0;
+    mVsyncCount = 0;
+    mTouchboostDisable = false;
+    mTimerSet = false;
+    mVsyncBoost = false;
+}
+
+bool TouchClassifier::onInteraction(long long nowNs)
+{
+    double diff = (nowNs - mPrevTouchNs) / NSEC_PER_MSEC;
+
+    mPrevTouchNs = nowNs;
+    mLastTouchNs = nowNs;
+    if (diff < mParams.shortTouchMs) {
+        mConsecutiveTouch++;
+    } else if (diff > mParams.longTouchMs) {
+        mVsyncBoost = false;
+        mTimerSet = false;
+        mTouchboostDisable = false;
+        mVsyncCount = 0;
+        mConsecutiveTouch = 0;
+    }
+    /* Simple touch: timer rate need not be changed here */
+    if (diff < mParams.shortTouchMs && !mTouchboostDisable
+            && mConsecutiveTouch > mParams.scrollTouchCount)
+        mTouchboostDisable = true;
+    /*
+     * Scrolling: timer rate reduced to increase sensitivity. No more touch
+     * boost after this
+     */
+    if (mTouchboostDisable && mConsecutiveTouch > mParams.scrollTimerCount
+            && !mTimerSet)
+        mTimerSet = true;
+
+    return !mTouchboostDisable;
+}
+
+bool TouchClassifier::onVsync(long long nowNs, bool frameRequested)
+{
+    double diff;
+
+    if (mTouchboostDisable) {
+        diff = (nowNs - mLastTouchNs) / NSEC_PER_MSEC;
+        if (diff > mParams.vsyncTouchMs) {
+            mTimerSet = false;
+            mVsyncBoost = true;
+            mTouchboostDisable = false;
+            mVsyncCount = mParams.vsyncBoostCount;
+        }
+    }
+    if (mVsyncBoost && frameRequested && mVsyncCount > 0) {
+        mVsyncCount--;
+        if (mVsyncCount == 0)
+            mVsyncBoost = false;
+        return true;
+    }
+    return false;
+}
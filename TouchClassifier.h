@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2014 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_TOUCH_CLASSIFIER_H
+#define ANDROID_TOUCH_CLASSIFIER_H
+
+/*
+ * Any two touch hints received within this interval (ms) are
+ * considered part of a scroll.
+ */
+#define SHORT_TOUCH_TIME 20
+
+/*
+ * A touch hint received after this interval (ms) since the previous one
+ * is considered a first touch.
+ */
+#define LONG_TOUCH_TIME 100
+
+/*
+ * If the time (ms) between the last touch and a vsync hint exceeds this,
+ * the finger has been released and vsync boosting takes over.
+ */
+#define VSYNC_TOUCH_TIME 30
+
+/* number of vsync boosts done after the finger release event */
+#define VSYNC_BOOST_COUNT 4
+
+/* consecutive short touches before touch boosting is turned off */
+#define SCROLL_TOUCH_COUNT 4
+
+/* consecutive short touches before the scroll timer rate kicks in */
+#define SCROLL_TIMER_COUNT 15
+
+/* predictive mode: boost held for a tap, and the cap on any prediction */
+#define PREDICT_BASE_BOOST_MS 80
+#define PREDICT_MAX_BOOST_MS 1500
+/* fling tail predicted for a scroll streaming at SHORT_TOUCH_TIME */
+#define PREDICT_FLING_TAIL_MS 400
+
+struct TouchParams {
+    int shortTouchMs;
+    int longTouchMs;
+    int vsyncTouchMs;
+    int vsyncBoostCount;
+    int scrollTouchCount;
+    int scrollTimerCount;
+    /* arm one predicted lease per gesture instead of pulsing */
+    int predictive;
+    int predictBaseBoostMs;
+    int predictMaxBoostMs;
+    int predictFlingTailMs;
+};
+
+/**
+ * Decides from the interaction/vsync hint stream when to pulse the
+ * touch boost. Timestamps are passed in so captures can be replayed
+ * offline through exactly the logic running in the HAL. Not thread
+ * safe; power_hint calls it under the module lock.
+ */
+class TouchClassifier {
+
+  private:
+      TouchParams mParams;
+      long long mPrevTouchNs;
+      long long mLastTouchNs;
+      int mConsecutiveTouch;
+      int mVsyncCount;
+      bool mTouchboostDisable;
+      bool mTimerSet;
+      bool mVsyncBoost;
+
+  public:
+      TouchClassifier();
+      virtual ~TouchClassifier(){};
+      static void defaultParams(TouchParams *params);
+      void setParams(const TouchParams &params) { mParams = params; };
+      const TouchParams &params() const { return mParams; };
+      void reset();
+      /* both return true when a touch boost pulse should be issued */
+      bool onInteraction(long long nowNs);
+      bool onVsync(long long nowNs, bool frameRequested);
+      bool scrolling() const { return mTouchboostDisable; };
+      bool timerSet() const { return mTimerSet; };
+      /* false while no vsync hint can lead to a pulse */
+      bool wantsVsync() const { return mTouchboostDisable || mVsyncBoost; };
+};
+#endif  // ANDROID_TOUCH_CLASSIFIER_H
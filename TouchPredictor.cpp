@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2014 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "TouchPredictor.h"
+
+#define NSEC_PER_MSEC 1000000LL
+/* EWMA weight of the newest interval, as a shift: 1/4 */
+#define PREDICT_EWMA_SHIFT 2
+/* level of a scroll at SHORT_TOUCH_TIME, in percent of the full level */
+#define PREDICT_MIN_LEVEL_PCT 50
+
+TouchPredictor::TouchPredictor()
+{
+    TouchClassifier::defaultParams(&mParams);
+    reset();
+}
+
+void TouchPredictor::reset()
+{
+    mLastTouchNs = 0;
+    mEwmaNs = 0;
+    mLeaseEndNs = 0;
+    mLeaseLevelPct = 0;
+    mLevelPct = 100;
+    mTouches = 0;
+}
+
+long long TouchPredictor::onInteraction(long long nowNs)
+{
+    long long interval = nowNs - mLastTouchNs;
+    long long shortNs = mParams.shortTouchMs * NSEC_PER_MSEC;
+    long long need = mParams.predictBaseBoostMs * NSEC_PER_MSEC;
+    long long maxNs = mParams.predictMaxBoostMs * NSEC_PER_MSEC;
+    long long tail;
+
+    mLastTouchNs = nowNs;
+    if (interval > mParams.longTouchMs * NSEC_PER_MSEC) {
+        /* first touch of a gesture */
+        mEwmaNs = 0;
+        mTouches = 1;
+    } else {
+        mEwmaNs = mEwmaNs ? mEwmaNs + ((interval - mEwmaNs) >> PREDICT_EWMA_SHIFT) : interval;
+        mTouches++;
+    }
+
+    /*
+     * Scrolling: cover the next couple of touches plus a fling tail that
+     * scales with the touch rate, relative to a scroll at SHORT_TOUCH_TIME.
+     * The level rises from PREDICT_MIN_LEVEL_PCT there to the full level
+     * as the interval shrinks; taps, whose response matters most, and
+     * gestures too slow to tell keep the full level.
+     */
+    mLevelPct = 100;
+    if (mEwmaNs > 0 && mEwmaNs < shortNs) {
+        tail = mParams.predictFlingTailMs * NSEC_PER_MSEC * shortNs / mEwmaNs;
+        if (2 * mEwmaNs + tail > need)
+            need = 2 * mEwmaNs + tail;
+        mLevelPct = PREDICT_MIN_LEVEL_PCT + (int)
+                    ((100 - PREDICT_MIN_LEVEL_PCT) * (shortNs - mEwmaNs) / shortNs);
+    }
+    if (need > maxNs)
+        need = maxNs;
+
+    /* keep the lease if it still covers at least half the prediction at its level */
+    if (mLeaseEndNs - nowNs >= need / 2 && mLeaseLevelPct >= mLevelPct)
+        return 0;
+    mLeaseEndNs = nowNs + need;
+    mLeaseLevelPct = mLevelPct;
+    return need;
+}
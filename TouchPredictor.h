@@ -0,0 +1,57 @@
+/*
+ * Copyright (C) 2014 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_TOUCH_PREDICTOR_H
+#define ANDROID_TOUCH_PREDICTOR_H
+
+#include "TouchClassifier.h"
+
+/**
+ * Predictive alternative to the pulse classifier. An EWMA of the
+ * inter-touch interval tells taps from scrolls and doubles as a fling
+ * velocity proxy: the faster touches stream in, the longer the content
+ * keeps moving after release. Each hint yields the boost the gesture is
+ * expected to need; the caller only re-arms its lease when the running
+ * one would end too early, so a gesture costs a handful of timer
+ * updates and one boost on/off pair. The same proxy scales the boost
+ * level: taps keep the full level, scrolls get more of it the faster
+ * they stream. Not thread safe, like TouchClassifier.
+ */
+class TouchPredictor {
+
+  private:
+      TouchParams mParams;
+      long long mLastTouchNs;
+      /* smoothed inter-touch interval of the current gesture, 0 if none */
+      long long mEwmaNs;
+      long long mLeaseEndNs;
+      /* level of the running lease and of the latest prediction, percent of full */
+      int mLeaseLevelPct;
+      int mLevelPct;
+      unsigned int mTouches;
+
+  public:
+      TouchPredictor();
+      virtual ~TouchPredictor(){};
+      void setParams(const TouchParams &params) { mParams = params; };
+      void reset();
+      /* boost duration to arm from nowNs, 0 if the running lease suffices */
+      long long onInteraction(long long nowNs);
+      /* boost level the gesture needs, in percent of the caller's full level */
+      int levelPct() const { return mLevelPct; };
+      long long ewmaNs() const { return mEwmaNs; };
+};
+#endif  // ANDROID_TOUCH_PREDICTOR_H
@@ -0,0 +1,66 @@
+# Copyright (C) 2014 The Android Open Source Project
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+LOCAL_PATH := $(call my-dir)
+POWERHAL_PATH := $(LOCAL_PATH)/..
+
+include $(CLEAR_VARS)
+
+LOCAL_MODULE := android.hardware.power-service.intel
+LOCAL_MODULE_RELATIVE_PATH := hw
+LOCAL_VENDOR_MODULE := true
+
+LOCAL_C_INCLUDES += $(POWERHAL_PATH) \
+                    hardware/libhardware/include
+
+# IPower front end
+LOCAL_SRC_FILES := service.cpp \
+                   Power.cpp
+
+# the same HAL logic the legacy module hosts
+LOCAL_SRC_FILES += ../power.cpp \
+                   ../PowerFs.cpp \
+                   ../SysfsNode.cpp \
+                   ../SysfsActuator.cpp \
+                   ../BoostScheduler.cpp \
+                   ../BoostArbiter.cpp \
+                   ../GovernorBackend.cpp \
+                   ../CGroupBoostController.cpp \
+                   ../GpuBoostController.cpp \
+                   ../AdaptiveBoostController.cpp \
+                   ../TouchClassifier.cpp \
+                   ../TouchPredictor.cpp \
+                   ../PowerTunables.cpp \
+                   ../HintRecorder.cpp \
+                   ../DevicePowerMonitor.cpp \
+                   ../DevicePowerMonitorInfo.cpp \
+                   ../ScreenStateController.cpp \
+                   ../CGroupCpusetController.cpp \
+                   ../CpuTopology.cpp \
+                   ../EppController.cpp \
+                   ../SustainedController.cpp
+
+LOCAL_SHARED_LIBRARIES := liblog libcutils libutils libdl libbinder_ndk \
+                          android.hardware.power-V1-ndk_platform
+
+ifneq ($(TARGET_BUILD_VARIANT),user)
+    LOCAL_CFLAGS += -DPOWERHAL_DEBUG
+endif
+
+LOCAL_MODULE_OWNER := intel
+
+LOCAL_INIT_RC := android.hardware.power-service.intel.rc
+LOCAL_VINTF_FRAGMENTS := power-intel.xml
+
+include $(BUILD_EXECUTABLE)
@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2014 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "PowerHAL"
+
+#include "Power.h"
+#include "PowerHal.h"
+
+#include <cutils/log.h>
+
+namespace aidl {
+namespace android {
+namespace hardware {
+namespace power {
+namespace impl {
+namespace intel {
+
+#define NSEC_PER_MSEC 1000000LL
+
+ndk::ScopedAStatus Power::setMode(Mode type, bool enabled)
+{
+    ALOGV("setMode %s %d", toString(type).c_str(), enabled);
+    switch (type) {
+    case Mode::INTERACTIVE:
+        powerhal_set_interactive(enabled);
+        break;
+    case Mode::LOW_POWER:
+        powerhal_set_mode(POWERHAL_MODE_LOW_POWER, enabled);
+        break;
+    case Mode::SUSTAINED_PERFORMANCE:
+        powerhal_set_mode(POWERHAL_MODE_SUSTAINED_PERFORMANCE, enabled);
+        break;
+    case Mode::VR:
+        powerhal_set_mode(POWERHAL_MODE_VR, enabled);
+        break;
+    case Mode::LAUNCH:
+        powerhal_set_mode(POWERHAL_MODE_LAUNCH, enabled);
+        break;
+    default:
+        break;
+    }
+    return ndk::ScopedAStatus::ok();
+}
+
+ndk::ScopedAStatus Power::isModeSupported(Mode type, bool *_aidl_return)
+{
+    switch (type) {
+    case Mode::INTERACTIVE:
+    case Mode::LOW_POWER:
+    case Mode::SUSTAINED_PERFORMANCE:
+    case Mode::VR:
+    case Mode::LAUNCH:
+        *_aidl_return = true;
+        break;
+    default:
+        *_aidl_return = false;
+        break;
+    }
+    return ndk::ScopedAStatus::ok();
+}
+
+ndk::ScopedAStatus Power::setBoost(Boost type, int32_t durationMs)
+{
+    long long durationNs = durationMs > 0 ? durationMs * NSEC_PER_MSEC : 0;
+
+    switch (type) {
+    case Boost::INTERACTION:
+        powerhal_boost_interaction(durationNs);
+        break;
+    case Boost::DISPLAY_UPDATE_IMMINENT:
+        powerhal_boost_display_update();
+        break;
+    case Boost::CAMERA_LAUNCH:
+        powerhal_boost_launch(durationNs);
+        break;
+    default:
+        break;
+    }
+    return ndk::ScopedAStatus::ok();
+}
+
+ndk::ScopedAStatus Power::isBoostSupported(Boost type, bool *_aidl_return)
+{
+    switch (type) {
+    case Boost::INTERACTION:
+    case Boost::DISPLAY_UPDATE_IMMINENT:
+    case Boost::CAMERA_LAUNCH:
+        *_aidl_return = true;
+        break;
+    default:
+        *_aidl_return = false;
+        break;
+    }
+    return ndk::ScopedAStatus::ok();
+}
+
+binder_status_t Power::dump(int fd, __attribute__((unused))const char **args,
+                            __attribute__((unused))uint32_t numArgs)
+{
+    powerhal_dump(fd);
+    return STATUS_OK;
+}
+
+}  // namespace intel
+}  // namespace impl
+}  // namespace power
+}  // namespace hardware
+}  // namespace android
+}  // namespace aidl
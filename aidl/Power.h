@@ -0,0 +1,50 @@
+/*
+ * Copyright (C) 2014 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_POWER_AIDL_POWER_H
+#define ANDROID_POWER_AIDL_POWER_H
+
+#include <aidl/android/hardware/power/BnPower.h>
+
+namespace aidl {
+namespace android {
+namespace hardware {
+namespace power {
+namespace impl {
+namespace intel {
+
+/**
+ * IPower front end over the shared HAL logic. setMode and setBoost are
+ * oneway in the interface; boosts only arm leases, so a client's binder
+ * call returns as soon as the transaction is queued and no sysfs write
+ * ever runs on it.
+ */
+class Power : public BnPower {
+  public:
+      ndk::ScopedAStatus setMode(Mode type, bool enabled) override;
+      ndk::ScopedAStatus isModeSupported(Mode type, bool *_aidl_return) override;
+      ndk::ScopedAStatus setBoost(Boost type, int32_t durationMs) override;
+      ndk::ScopedAStatus isBoostSupported(Boost type, bool *_aidl_return) override;
+      binder_status_t dump(int fd, const char **args, uint32_t numArgs) override;
+};
+
+}  // namespace intel
+}  // namespace impl
+}  // namespace power
+}  // namespace hardware
+}  // namespace android
+}  // namespace aidl
+#endif  // ANDROID_POWER_AIDL_POWER_H
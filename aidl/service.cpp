@@ -0,0 +1,53 @@
+/*
+ * Copyright (C) 2014 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "PowerHAL"
+
+#include "Power.h"
+#include "PowerHal.h"
+
+#include <android/binder_manager.h>
+#include <android/binder_process.h>
+#include <cutils/log.h>
+
+#include <stdlib.h>
+#include <string>
+
+using aidl::android::hardware::power::impl::intel::Power;
+
+/*
+ * Oneway transactions to one binder node are delivered in order on a
+ * single thread anyway; the extra thread keeps the synchronous
+ * isModeSupported/isBoostSupported queries and dumpsys off that queue.
+ */
+#define POWER_SERVICE_THREADS 2
+
+int main()
+{
+    powerhal_init();
+
+    ABinderProcess_setThreadPoolMaxThreadCount(POWER_SERVICE_THREADS);
+    std::shared_ptr<Power> power = ndk::SharedRefBase::make<Power>();
+    const std::string instance = std::string() + Power::descriptor + "/default";
+    if (AServiceManager_addService(power->asBinder().get(), instance.c_str()) != STATUS_OK) {
+        ALOGE("Could not register %s", instance.c_str());
+        return EXIT_FAILURE;
+    }
+
+    ABinderProcess_startThreadPool();
+    ABinderProcess_joinThreadPool();
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,122 @@
+# Copyright (C) 2014 The Android Open Source Project
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+LOCAL_PATH := $(call my-dir)
+POWERHAL_PATH := $(LOCAL_PATH)/..
+
+include $(CLEAR_VARS)
+
+LOCAL_MODULE := power_bench
+LOCAL_MODULE_TAGS := optional
+
+LOCAL_C_INCLUDES += $(POWERHAL_PATH) \
+                    hardware/libhardware/include
+
+# the HAL is compiled in so the fake filesystem can be installed first
+LOCAL_SRC_FILES := power_bench.cpp \
+                   BenchTree.cpp \
+                   FakeFs.cpp \
+                   ../power.cpp \
+                   ../PowerFs.cpp \
+                   ../SysfsNode.cpp \
+                   ../SysfsActuator.cpp \
+                   ../BoostScheduler.cpp \
+                   ../BoostArbiter.cpp \
+                   ../GovernorBackend.cpp \
+                   ../CGroupBoostController.cpp \
+                   ../GpuBoostController.cpp \
+                   ../AdaptiveBoostController.cpp \
+                   ../HintRecorder.cpp \
+                   ../TouchClassifier.cpp \
+                   ../TouchPredictor.cpp \
+                   ../PowerTunables.cpp \
+                   ../DevicePowerMonitor.cpp \
+                   ../DevicePowerMonitorInfo.cpp \
+                   ../ScreenStateController.cpp \
+                   ../CGroupCpusetController.cpp \
+                   ../CpuTopology.cpp \
+                   ../EppController.cpp \
+                   ../SustainedController.cpp
+
+LOCAL_CFLAGS += -DPOWERHAL_DEBUG
+ifeq ($(APP_LAUNCH_BOOST), true)
+   LOCAL_CFLAGS += -DAPP_LAUNCH_BOOST
+endif
+
+# power_bench looks the module up with dlsym like the HAL loader does
+LOCAL_LDFLAGS += -rdynamic
+LOCAL_LDLIBS += -ldl -lpthread
+LOCAL_STATIC_LIBRARIES := libcutils liblog
+
+include $(BUILD_HOST_EXECUTABLE)
+
+# scripted scenarios scored for latency and energy; runs on the device
+include $(CLEAR_VARS)
+
+LOCAL_MODULE := power_scenarios
+LOCAL_MODULE_TAGS := optional
+LOCAL_MODULE_PATH := $(TARGET_OUT_VENDOR_EXECUTABLES)
+
+LOCAL_C_INCLUDES += $(POWERHAL_PATH) \
+                    hardware/libhardware/include
+
+LOCAL_SRC_FILES := power_scenarios.cpp \
+                   RecordingFs.cpp \
+                   BenchTree.cpp \
+                   FakeFs.cpp \
+                   ../power.cpp \
+                   ../PowerFs.cpp \
+                   ../SysfsNode.cpp \
+                   ../SysfsActuator.cpp \
+                   ../BoostScheduler.cpp \
+                   ../BoostArbiter.cpp \
+                   ../GovernorBackend.cpp \
+                   ../CGroupBoostController.cpp \
+                   ../GpuBoostController.cpp \
+                   ../AdaptiveBoostController.cpp \
+                   ../HintRecorder.cpp \
+                   ../TouchClassifier.cpp \
+                   ../TouchPredictor.cpp \
+                   ../PowerTunables.cpp \
+                   ../DevicePowerMonitor.cpp \
+                   ../DevicePowerMonitorInfo.cpp \
+                   ../ScreenStateController.cpp \
+                   ../CGroupCpusetController.cpp \
+                   ../CpuTopology.cpp \
+                   ../EppController.cpp \
+                   ../SustainedController.cpp
+
+LOCAL_CFLAGS += -DPOWERHAL_DEBUG
+ifeq ($(APP_LAUNCH_BOOST), true)
+   LOCAL_CFLAGS += -DAPP_LAUNCH_BOOST
+endif
+
+LOCAL_LDFLAGS += -rdynamic
+LOCAL_SHARED_LIBRARIES := libcutils liblog
+
+include $(BUILD_EXECUTABLE)
+
+include $(CLEAR_VARS)
+
+LOCAL_MODULE := hint_replay
+LOCAL_MODULE_TAGS := optional
+
+LOCAL_C_INCLUDES += $(POWERHAL_PATH) \
+                    hardware/libhardware/include
+
+LOCAL_SRC_FILES := hint_replay.cpp \
+                   ../TouchClassifier.cpp \
+                   ../TouchPredictor.cpp
+
+include $(BUILD_HOST_EXECUTABLE)
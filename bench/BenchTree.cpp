@@ -0,0 +1,204 @@
+/*
+ * Copyright (C) 2014 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "BenchTree.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "PowerFs.h"
+
+#define HAL_DIR "/sys/power/power_HAL_suspend"
+#define DEVICE_CONTROL_FILE "power_HAL_suspend"
+
+static FakeFs *fakeFs;
+static const char *treeRoot = "";
+static int devicesCurrent;
+
+void bench_tree_init(FakeFs *fake, const char *root)
+{
+    fakeFs = fake;
+    treeRoot = root ? root : "";
+}
+
+/* mkdir -p for the tmpfs tree */
+static void make_dirs(const char *path)
+{
+    char buf[PATH_MAX];
+    char *p;
+
+    snprintf(buf, sizeof(buf), "%s", path);
+    for (p = buf + 1; *p; p++) {
+        if (*p != '/')
+            continue;
+        *p = '\0';
+        mkdir(buf, 0755);
+        *p = '/';
+    }
+}
+
+static void create_file(const char *path, const char *content)
+{
+    char real[PATH_MAX];
+    int fd;
+
+    if (fakeFs) {
+        fakeFs->addFile(path, content);
+        return;
+    }
+    snprintf(real, sizeof(real), "%s%s", treeRoot, path);
+    make_dirs(real);
+    fd = open(real, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        fprintf(stderr, "cannot create %s: %s\n", real, strerror(errno));
+        exit(1);
+    }
+    write(fd, content, strlen(content));
+    close(fd);
+}
+
+static void remove_file(const char *path)
+{
+    char real[PATH_MAX];
+
+    if (fakeFs) {
+        fakeFs->removeFile(path);
+        return;
+    }
+    snprintf(real, sizeof(real), "%s%s", treeRoot, path);
+    unlink(real);
+}
+
+static void device_path(int i, char *buf, size_t size)
+{
+    /* a mix of critical and normal phase devices */
+    if (i % 4 == 0)
+        snprintf(buf, size, "%s/i2c-%d/%s", HAL_DIR, i, DEVICE_CONTROL_FILE);
+    else
+        snprintf(buf, size, "%s/dev%d/%s", HAL_DIR, i, DEVICE_CONTROL_FILE);
+}
+
+void bench_tree_set_devices(int count)
+{
+    char path[PATH_MAX];
+    int i;
+
+    for (i = count; i < devicesCurrent; i++) {
+        device_path(i, path, sizeof(path));
+        remove_file(path);
+    }
+    for (i = devicesCurrent; i < count; i++) {
+        device_path(i, path, sizeof(path));
+        create_file(path, "0");
+    }
+    devicesCurrent = count;
+}
+
+int bench_tree_count_devices(const char *value)
+{
+    PowerFs *fs = PowerFs::get();
+    char path[PATH_MAX];
+    char current;
+    int count = 0;
+    int fd;
+    int i;
+
+    for (i = 0; i < devicesCurrent; i++) {
+        device_path(i, path, sizeof(path));
+        fd = fs->open(path, O_RDONLY);
+        if (fd < 0)
+            continue;
+        if (fs->pread(fd, &current, 1, 0) == 1 && current == value[0])
+            count++;
+        fs->close(fd);
+    }
+    return count;
+}
+
+static void policy_file(const char *dir, const char *node, const char *content)
+{
+    char path[PATH_MAX];
+
+    snprintf(path, sizeof(path), "%s%s", dir, node);
+    create_file(path, content);
+}
+
+void bench_tree_setup(const char *governor)
+{
+    char path[PATH_MAX];
+    int i;
+
+    if (!strcmp(governor, "interactive")) {
+        create_file("/sys/devices/system/cpu/cpufreq/interactive/touchboostpulse", "0");
+        create_file("/sys/devices/system/cpu/cpufreq/interactive/boost", "0");
+        create_file("/sys/devices/system/cpu/cpufreq/interactive/boostpulse_duration", "80000");
+        /* the sustained cap goes through scaling_max_freq */
+        for (i = 0; i < BENCH_CPUS; i++) {
+            snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpufreq/policy%d/", i);
+            policy_file(path, "scaling_governor", "interactive");
+            policy_file(path, "cpuinfo_min_freq", "800000");
+            policy_file(path, "cpuinfo_max_freq", "4000000");
+            policy_file(path, "scaling_min_freq", "800000");
+            policy_file(path, "scaling_max_freq", "4000000");
+        }
+    } else if (!strcmp(governor, "schedutil")) {
+        /* a 5.4+ kernel: no schedtune, foreground boost through uclamp */
+        for (i = 0; i < BENCH_CPUS; i++) {
+            snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpufreq/policy%d/", i);
+            policy_file(path, "scaling_governor", "schedutil");
+            policy_file(path, "cpuinfo_min_freq", "800000");
+            policy_file(path, "cpuinfo_max_freq", "4000000");
+            policy_file(path, "scaling_min_freq", "800000");
+            policy_file(path, "scaling_max_freq", "4000000");
+        }
+        create_file("/dev/cpuctl/top-app/cpu.uclamp.min", "0.00");
+        create_file("/dev/cpuctl/foreground/cpu.uclamp.min", "0.00");
+    } else {
+        create_file("/sys/devices/system/cpu/intel_pstate/min_perf_pct", "30");
+        create_file("/sys/devices/system/cpu/intel_pstate/max_perf_pct", "100");
+        for (i = 0; i < BENCH_CPUS; i++) {
+            snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpufreq/policy%d/", i);
+            policy_file(path, "scaling_governor", "powersave");
+            policy_file(path, "cpuinfo_min_freq", "800000");
+            policy_file(path, "cpuinfo_max_freq", "4000000");
+            policy_file(path, "scaling_min_freq", "800000");
+            policy_file(path, "scaling_max_freq", "4000000");
+            policy_file(path, "energy_performance_preference", "balance_performance");
+            policy_file(path, "energy_performance_available_preferences",
+                        "default performance balance_performance balance_power power");
+        }
+    }
+    if (strcmp(governor, "schedutil"))
+        create_file("/dev/stune/foreground/schedtune.boost", "10");
+    create_file("/dev/cpuset/cpus", "0-3");
+    create_file("/dev/cpuset/foreground/cpus", "0-3");
+    create_file("/dev/cpuset/background/cpus", "0");
+    create_file("/dev/cpuset/top-app/cpus", "0-3");
+    create_file("/dev/cpuset/non_interactive/cpus", "0-1");
+    create_file("/sys/devices/system/cpu/online", "0-3");
+    /* a package zone running hot, so the sustained loop has to back off */
+    create_file("/sys/class/thermal/thermal_zone0/type", "x86_pkg_temp");
+    create_file("/sys/class/thermal/thermal_zone0/temp", "95000");
+    create_file("/sys/class/thermal/thermal_zone0/trip_point_0_type", "passive");
+    create_file("/sys/class/thermal/thermal_zone0/trip_point_0_temp", "90000");
+    bench_tree_set_devices(1);
+}
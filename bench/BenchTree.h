@@ -0,0 +1,35 @@
+/*
+ * Copyright (C) 2014 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_POWER_BENCH_TREE_H
+#define ANDROID_POWER_BENCH_TREE_H
+
+#include "FakeFs.h"
+
+#define BENCH_CPUS 4
+
+/**
+ * The sysfs and cgroupfs nodes the HAL probes, for one governor, laid
+ * out either in a FakeFs or under a tmpfs root. Host benchmarks build
+ * the tree before power_init; set_devices() then grows or shrinks the
+ * suspendable device inventory and count_devices() reads it back.
+ */
+void bench_tree_init(FakeFs *fake, const char *root);
+void bench_tree_setup(const char *governor);
+void bench_tree_set_devices(int count);
+/* devices whose power_HAL_suspend node holds value */
+int bench_tree_count_devices(const char *value);
+#endif  // ANDROID_POWER_BENCH_TREE_H
@@ -0,0 +1,209 @@
+/*
+ * Copyright (C) 2014 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "FakeFs.h"
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+
+/* keep fake descriptors clear of real ones in logs */
+#define FAKE_FD_BASE 1000
+
+FakeFs::FakeFs():
+    mWriteLatencyUs(0),
+    mWrites(0)
+{
+    pthread_mutex_init(&mLock, NULL);
+}
+
+FakeFs::~FakeFs()
+{
+    pthread_mutex_destroy(&mLock);
+}
+
+bool FakeFs::lookup(int fd, std::string *path)
+{
+    size_t slot = fd - FAKE_FD_BASE;
+
+    if (fd < FAKE_FD_BASE || slot >= mFds.size() || !mFds[slot].used)
+        return false;
+    *path = mFds[slot].path;
+    return true;
+}
+
+int FakeFs::open(const char *path, __attribute__((unused))int flags)
+{
+    size_t slot;
+
+    pthread_mutex_lock(&mLock);
+    if (mFiles.find(path) == mFiles.end()) {
+        pthread_mutex_unlock(&mLock);
+        errno = ENOENT;
+        return -1;
+    }
+    for (slot = 0; slot < mFds.size(); slot++)
+        if (!mFds[slot].used)
+            break;
+    if (slot == mFds.size())
+        mFds.push_back(OpenFile());
+    mFds[slot].path = path;
+    mFds[slot].used = true;
+    pthread_mutex_unlock(&mLock);
+    return FAKE_FD_BASE + slot;
+}
+
+int FakeFs::close(int fd)
+{
+    std::string path;
+
+    pthread_mutex_lock(&mLock);
+    if (!lookup(fd, &path)) {
+        pthread_mutex_unlock(&mLock);
+        errno = EBADF;
+        return -1;
+    }
+    mFds[fd - FAKE_FD_BASE].used = false;
+    pthread_mutex_unlock(&mLock);
+    return 0;
+}
+
+ssize_t FakeFs::pread(int fd, void *buf, size_t len, off_t offset)
+{
+    std::map<std::string, std::string>::iterator it;
+    std::string path;
+    size_t n = 0;
+
+    pthread_mutex_lock(&mLock);
+    if (!lookup(fd, &path)) {
+        pthread_mutex_unlock(&mLock);
+        errno = EBADF;
+        return -1;
+    }
+    it = mFiles.find(path);
+    if (it == mFiles.end()) {
+        pthread_mutex_unlock(&mLock);
+        errno = ENODEV;
+        return -1;
+    }
+    if ((size_t)offset < it->second.size()) {
+        n = it->second.size() - offset;
+        if (n > len)
+            n = len;
+        memcpy(buf, it->second.data() + offset, n);
+    }
+    pthread_mutex_unlock(&mLock);
+    return n;
+}
+
+ssize_t FakeFs::pwrite(int fd, const void *buf, size_t len, __attribute__((unused))off_t offset)
+{
+    std::map<std::string, std::string>::iterator it;
+    std::string path;
+
+    /* the driver callback runs outside any fs lock, like the real store */
+    if (mWriteLatencyUs)
+        usleep(mWriteLatencyUs);
+
+    pthread_mutex_lock(&mLock);
+    if (!lookup(fd, &path)) {
+        pthread_mutex_unlock(&mLock);
+        errno = EBADF;
+        return -1;
+    }
+    it = mFiles.find(path);
+    if (it == mFiles.end()) {
+        pthread_mutex_unlock(&mLock);
+        errno = ENODEV;
+        return -1;
+    }
+    it->second.assign((const char *)buf, len);
+    mWrites++;
+    pthread_mutex_unlock(&mLock);
+    return len;
+}
+
+int FakeFs::access(const char *path, __attribute__((unused))int mode)
+{
+    int ret = 0;
+
+    pthread_mutex_lock(&mLock);
+    if (mFiles.find(path) == mFiles.end()) {
+        errno = ENOENT;
+        ret = -1;
+    }
+    pthread_mutex_unlock(&mLock);
+    return ret;
+}
+
+int FakeFs::listDir(const char *path, std::vector<std::string> *names)
+{
+    std::map<std::string, std::string>::iterator it;
+    std::string prefix = std::string(path) + "/";
+    std::string entry;
+
+    names->clear();
+    pthread_mutex_lock(&mLock);
+    for (it = mFiles.lower_bound(prefix); it != mFiles.end(); ++it) {
+        if (it->first.compare(0, prefix.size(), prefix))
+            break;
+        entry = it->first.substr(prefix.size());
+        entry = entry.substr(0, entry.find('/'));
+        if (names->empty() || names->back() != entry)
+            names->push_back(entry);
+    }
+    pthread_mutex_unlock(&mLock);
+    if (names->empty()) {
+        errno = ENOENT;
+        return -1;
+    }
+    return 0;
+}
+
+void FakeFs::addFile(const char *path, const char *content)
+{
+    pthread_mutex_lock(&mLock);
+    mFiles[path] = content;
+    pthread_mutex_unlock(&mLock);
+}
+
+void FakeFs::removeFile(const char *path)
+{
+    pthread_mutex_lock(&mLock);
+    mFiles.erase(path);
+    pthread_mutex_unlock(&mLock);
+}
+
+std::string FakeFs::content(const char *path)
+{
+    std::string ret;
+
+    pthread_mutex_lock(&mLock);
+    if (mFiles.find(path) != mFiles.end())
+        ret = mFiles[path];
+    pthread_mutex_unlock(&mLock);
+    return ret;
+}
+
+unsigned long long FakeFs::writes()
+{
+    unsigned long long ret;
+
+    pthread_mutex_lock(&mLock);
+    ret = mWrites;
+    pthread_mutex_unlock(&mLock);
+    return ret;
+}
@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2014 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_POWER_FAKE_FS_H
+#define ANDROID_POWER_FAKE_FS_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <pthread.h>
+
+#include "PowerFs.h"
+
+/**
+ * In-memory sysfs for host benchmarks. Files must be created up front,
+ * a write replaces the whole content like a sysfs store does, and every
+ * write can be delayed to model slow driver callbacks.
+ */
+class FakeFs : public PowerFs {
+
+  private:
+      struct OpenFile {
+          std::string path;
+          bool used;
+      };
+
+      std::map<std::string, std::string> mFiles;
+      std::vector<OpenFile> mFds;
+      pthread_mutex_t mLock;
+      unsigned int mWriteLatencyUs;
+      unsigned long long mWrites;
+
+      bool lookup(int fd, std::string *path);
+
+  public:
+      FakeFs();
+      virtual ~FakeFs();
+      virtual int open(const char *path, int flags);
+      virtual int close(int fd);
+      virtual ssize_t pread(int fd, void *buf, size_t len, off_t offset);
+      virtual ssize_t pwrite(int fd, const void *buf, size_t len, off_t offset);
+      virtual int access(const char *path, int mode);
+      virtual int listDir(const char *path, std::vector<std::string> *names);
+
+      void addFile(const char *path, const char *content);
+      void removeFile(const char *path);
+      std::string content(const char *path);
+      void setWriteLatencyUs(unsigned int us) { mWriteLatencyUs = us; };
+      unsigned long long writes();
+};
+#endif  // ANDROID_POWER_FAKE_FS_H
@@ -0,0 +1,235 @@
+/*
+ * Copyright (C) 2014 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "RecordingFs.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static const char* BOOST_NODES[] = {
+    "/interactive/boost",
+    "/min_perf_pct",
+    "/scaling_min_freq",
+    "/schedtune.boost",
+    "/cpu.uclamp.min",
+    "/gt_min_freq_mhz",
+};
+static const char* PULSE_NODES[] = {
+    "/touchboostpulse",
+};
+static const char* EPP_NODES[] = {
+    "/energy_performance_preference",
+};
+
+#define VALUE_MAX 64
+
+static bool has_suffix(const char *path, const char *suffix)
+{
+    size_t len = strlen(path);
+    size_t n = strlen(suffix);
+
+    return len >= n && !strcmp(path + len - n, suffix);
+}
+
+static std::string trim(const char *buf, size_t len)
+{
+    while (len && (buf[len - 1] == '\n' || buf[len - 1] == ' ' || buf[len - 1] == '\0'))
+        len--;
+    return std::string(buf, len);
+}
+
+long long RecordingFs::now()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+RecordingFs::RecordingFs(PowerFs *inner):
+    mInner(inner),
+    mBoostedNodes(0),
+    mBoostedSince(0)
+{
+    memset(&mStats, 0, sizeof(mStats));
+    pthread_mutex_init(&mLock, NULL);
+}
+
+RecordingFs::~RecordingFs()
+{
+    pthread_mutex_destroy(&mLock);
+}
+
+int RecordingFs::classify(const char *path)
+{
+    size_t i;
+
+    for (i = 0; i < sizeof(BOOST_NODES) / sizeof(BOOST_NODES[0]); i++)
+        if (has_suffix(path, BOOST_NODES[i]))
+            return NODE_BOOST;
+    for (i = 0; i < sizeof(PULSE_NODES) / sizeof(PULSE_NODES[0]); i++)
+        if (has_suffix(path, PULSE_NODES[i]))
+            return NODE_PULSE;
+    for (i = 0; i < sizeof(EPP_NODES) / sizeof(EPP_NODES[0]); i++)
+        if (has_suffix(path, EPP_NODES[i]))
+            return NODE_EPP;
+    if (!strncmp(path, "/dev/cpuset/", 12) && has_suffix(path, "/cpus"))
+        return NODE_CPUSET;
+    if (strstr(path, "power_HAL_suspend"))
+        return NODE_DEVICE;
+    return NODE_OTHER;
+}
+
+/* numeric nodes compare by value, so "0.00" and "0" are the same uclamp */
+bool RecordingFs::sameValue(const std::string &a, const std::string &b)
+{
+    char *endA, *endB;
+    double va = strtod(a.c_str(), &endA);
+    double vb = strtod(b.c_str(), &endB);
+
+    if (endA != a.c_str() && !*endA && endB != b.c_str() && !*endB)
+        return va == vb;
+    return a == b;
+}
+
+int RecordingFs::open(const char *path, int flags)
+{
+    char buf[VALUE_MAX];
+    ssize_t len;
+    Node node;
+    int fd;
+
+    fd = mInner->open(path, flags);
+    if (fd < 0)
+        return fd;
+    node.cls = classify(path);
+    node.boosted = false;
+    /* write-only nodes keep an empty baseline */
+    len = node.cls == NODE_BOOST ? mInner->pread(fd, buf, sizeof(buf), 0) : -1;
+    if (len > 0)
+        node.baseline = trim(buf, len);
+    pthread_mutex_lock(&mLock);
+    mNodes[fd] = node;
+    pthread_mutex_unlock(&mLock);
+    return fd;
+}
+
+int RecordingFs::close(int fd)
+{
+    std::map<int, Node>::iterator it;
+    long long t = now();
+
+    pthread_mutex_lock(&mLock);
+    it = mNodes.find(fd);
+    if (it != mNodes.end()) {
+        if (it->second.boosted && --mBoostedNodes == 0)
+            mStats.boostedNs += t - mBoostedSince;
+        mNodes.erase(it);
+    }
+    pthread_mutex_unlock(&mLock);
+    return mInner->close(fd);
+}
+
+ssize_t RecordingFs::pread(int fd, void *buf, size_t len, off_t offset)
+{
+    return mInner->pread(fd, buf, len, offset);
+}
+
+ssize_t RecordingFs::pwrite(int fd, const void *buf, size_t len, off_t offset)
+{
+    std::map<int, Node>::iterator it;
+    ssize_t ret;
+    long long t;
+    bool boosted;
+    int cls = NODE_OTHER;
+
+    ret = mInner->pwrite(fd, buf, len, offset);
+    if (ret < 0)
+        return ret;
+    /* stamped once the write has landed, like the kernel sees it */
+    t = now();
+
+    pthread_mutex_lock(&mLock);
+    it = mNodes.find(fd);
+    if (it != mNodes.end()) {
+        Node *node = &it->second;
+
+        cls = node->cls;
+        if (cls == NODE_BOOST) {
+            boosted = !sameValue(trim((const char *)buf, len), node->baseline);
+            if (boosted && !node->boosted) {
+                if (mBoostedNodes++ == 0)
+                    mBoostedSince = t;
+                if (!mStats.firstBoostNs)
+                    mStats.firstBoostNs = t;
+            } else if (!boosted && node->boosted && --mBoostedNodes == 0) {
+                mStats.boostedNs += t - mBoostedSince;
+            }
+            node->boosted = boosted;
+        } else if (cls == NODE_PULSE) {
+            mStats.pulses++;
+            if (!mStats.firstBoostNs)
+                mStats.firstBoostNs = t;
+        }
+    }
+    mStats.writes++;
+    mStats.classWrites[cls]++;
+    mStats.lastWriteNs = t;
+    mStats.lastClassNs[cls] = t;
+    if (!mStats.firstClassNs[cls])
+        mStats.firstClassNs[cls] = t;
+    pthread_mutex_unlock(&mLock);
+    return ret;
+}
+
+int RecordingFs::access(const char *path, int mode)
+{
+    return mInner->access(path, mode);
+}
+
+int RecordingFs::listDir(const char *path, std::vector<std::string> *names)
+{
+    return mInner->listDir(path, names);
+}
+
+void RecordingFs::arm()
+{
+    pthread_mutex_lock(&mLock);
+    memset(mStats.firstClassNs, 0, sizeof(mStats.firstClassNs));
+    mStats.firstBoostNs = 0;
+    pthread_mutex_unlock(&mLock);
+}
+
+void RecordingFs::snapshot(Snapshot *s)
+{
+    pthread_mutex_lock(&mLock);
+    *s = mStats;
+    /* include the boost still in effect */
+    if (mBoostedNodes)
+        s->boostedNs += now() - mBoostedSince;
+    pthread_mutex_unlock(&mLock);
+}
+
+long long RecordingFs::lastWriteNs()
+{
+    long long t;
+
+    pthread_mutex_lock(&mLock);
+    t = mStats.lastWriteNs;
+    pthread_mutex_unlock(&mLock);
+    return t;
+}
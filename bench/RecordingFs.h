@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 2014 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_POWER_RECORDING_FS_H
+#define ANDROID_POWER_RECORDING_FS_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <pthread.h>
+
+#include "PowerFs.h"
+
+/**
+ * Pass-through backend that timestamps every write the HAL makes, so a
+ * scenario can tell when a boost landed and how long it stayed on
+ * without knowing which knobs the platform uses. Writes are classified
+ * by node path; a level node counts as boosted while its last written
+ * value differs from the one it had when the HAL opened it.
+ */
+class RecordingFs : public PowerFs {
+
+  public:
+      enum {
+          NODE_BOOST = 0,   /* level knobs: governor floors, cgroup boosts, GPU floor */
+          NODE_PULSE,       /* self-timed pulses, e.g. touchboostpulse */
+          NODE_CPUSET,      /* /dev/cpuset/<group>/cpus profiles */
+          NODE_EPP,         /* energy_performance_preference */
+          NODE_DEVICE,      /* power_HAL_suspend device controls */
+          NODE_OTHER,
+          NUM_NODE_CLASSES
+      };
+
+      /* counters are cumulative; first* only count writes since arm() */
+      struct Snapshot {
+          unsigned long long writes;
+          unsigned long long classWrites[NUM_NODE_CLASSES];
+          unsigned long long pulses;
+          long long boostedNs;
+          long long lastWriteNs;
+          long long lastClassNs[NUM_NODE_CLASSES];
+          long long firstClassNs[NUM_NODE_CLASSES];
+          long long firstBoostNs;
+      };
+
+      RecordingFs(PowerFs *inner);
+      virtual ~RecordingFs();
+      virtual int open(const char *path, int flags);
+      virtual int close(int fd);
+      virtual ssize_t pread(int fd, void *buf, size_t len, off_t offset);
+      virtual ssize_t pwrite(int fd, const void *buf, size_t len, off_t offset);
+      virtual int access(const char *path, int mode);
+      virtual int listDir(const char *path, std::vector<std::string> *names);
+
+      /* restart the first-write times at now */
+      void arm();
+      void snapshot(Snapshot *s);
+      long long lastWriteNs();
+
+      static long long now();
+
+  private:
+      struct Node {
+          int cls;
+          std::string baseline;
+          bool boosted;
+      };
+
+      PowerFs *mInner;
+      std::map<int, Node> mNodes;
+      /* number of level nodes away from their baseline */
+      int mBoostedNodes;
+      long long mBoostedSince;
+      Snapshot mStats;
+      pthread_mutex_t mLock;
+
+      static int classify(const char *path);
+      static bool sameValue(const std::string &a, const std::string &b);
+};
+#endif  // ANDROID_POWER_RECORDING_FS_H
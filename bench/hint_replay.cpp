@@ -0,0 +1,217 @@
+/*
+ * Copyright (C) 2014 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Offline replay of a hint capture (persist.powerhal.hint_trace) through
+ * the touch classifier the HAL runs, so tuning candidates can be compared
+ * on real scroll/fling traces without reflashing.
+ *
+ *   hint_replay [-s short_ms] [-L long_ms] [-v vsync_touch_ms]
+ *               [-c vsync_boost_count] [-p pulse_ms] [-P] [-e] capture
+ *
+ * Reports boosts issued, sysfs writes, time spent boosted and missed-boost
+ * windows: runs of vsyncs that requested a frame while no boost was in
+ * effect. -P replays the predictive lease mode instead of pulses; a pulse
+ * costs one touchboostpulse write, a predicted lease one boost on/off pair
+ * plus one write per level change while it runs.
+ * -e additionally prints every decision as "<t_ms> <hint> <data> <pulse>".
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <hardware/power.h>
+
+#include "HintRecorder.h"
+#include "TouchClassifier.h"
+#include "TouchPredictor.h"
+
+/* interactive governor default boostpulse_duration */
+#define DEFAULT_PULSE_MS 80
+#define NSEC_PER_MSEC 1000000LL
+
+struct ReplayStats {
+    unsigned int hints;
+    unsigned int pulses;
+    unsigned int writes;
+    long long boostedNs;
+    unsigned int missedWindows;
+    unsigned int missedFrames;
+    long long missedNs;
+};
+
+static int read_capture(const char *path, HintTraceRecord **records, uint32_t *count)
+{
+    HintTraceHeader header;
+    FILE *f;
+
+    f = fopen(path, "rb");
+    if (f == NULL) {
+        fprintf(stderr, "cannot open %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    if (fread(&header, sizeof(header), 1, f) != 1 || header.magic != HINT_TRACE_MAGIC
+            || header.version != HINT_TRACE_VERSION
+            || header.recordSize != sizeof(HintTraceRecord)) {
+        fprintf(stderr, "%s is not a hint capture\n", path);
+        fclose(f);
+        return -1;
+    }
+    if (header.dropped)
+        fprintf(stderr, "warning: %u hints were overwritten before capture\n", header.dropped);
+
+    *records = (HintTraceRecord *)calloc(header.count ? header.count : 1, sizeof(HintTraceRecord));
+    *count = fread(*records, sizeof(HintTraceRecord), header.count, f);
+    fclose(f);
+    if (*count != header.count)
+        fprintf(stderr, "warning: capture truncated at %u of %u hints\n", *count, header.count);
+    return 0;
+}
+
+static void replay(const TouchParams &params, const HintTraceRecord *records, uint32_t count,
+                   long long pulseNs, bool events, ReplayStats *stats)
+{
+    TouchClassifier classifier;
+    TouchPredictor predictor;
+    long long boostEnd = 0;
+    long long missStart = -1;
+    int levelPct = 0;
+    long long t0 = count ? records[0].timeNs : 0;
+    long long boostNs;
+    long long t;
+    bool pulse;
+    uint32_t i;
+
+    classifier.setParams(params);
+    predictor.setParams(params);
+    memset(stats, 0, sizeof(*stats));
+    for (i = 0; i < count; i++) {
+        t = records[i].timeNs;
+        boostNs = 0;
+        switch (records[i].hint) {
+        case POWER_HINT_INTERACTION:
+            if (params.predictive)
+                boostNs = predictor.onInteraction(t);
+            else if (classifier.onInteraction(t))
+                boostNs = pulseNs;
+            break;
+        case POWER_HINT_VSYNC:
+            if (!params.predictive && classifier.onVsync(t, records[i].data != 0))
+                boostNs = pulseNs;
+            break;
+        default:
+            continue;
+        }
+        stats->hints++;
+
+        pulse = boostNs > 0;
+        if (pulse) {
+            stats->pulses++;
+            if (!params.predictive)
+                stats->writes++;
+            else if (t >= boostEnd)
+                stats->writes += 2;
+            else if (predictor.levelPct() != levelPct)
+                stats->writes++;
+            if (params.predictive)
+                levelPct = predictor.levelPct();
+            /* count only the part not already covered by the running boost */
+            stats->boostedNs += boostNs - (boostEnd > t ? boostEnd - t : 0);
+            boostEnd = t + boostNs;
+        }
+
+        if (records[i].hint == POWER_HINT_VSYNC) {
+            if (records[i].data != 0 && t >= boostEnd) {
+                if (missStart < 0) {
+                    missStart = t;
+                    stats->missedWindows++;
+                }
+                stats->missedFrames++;
+            } else if (missStart >= 0) {
+                stats->missedNs += t - missStart;
+                missStart = -1;
+            }
+        }
+
+        if (events)
+            printf("%.3f %u %u %d\n", (t - t0) / (double)NSEC_PER_MSEC,
+                   records[i].hint, records[i].data, pulse);
+    }
+    if (missStart >= 0 && count)
+        stats->missedNs += records[count - 1].timeNs - missStart;
+}
+
+int main(int argc, char **argv)
+{
+    TouchParams params;
+    HintTraceRecord *records;
+    ReplayStats stats;
+    long long pulseMs = DEFAULT_PULSE_MS;
+    bool events = false;
+    uint32_t count;
+    int opt;
+
+    TouchClassifier::defaultParams(&params);
+    while ((opt = getopt(argc, argv, "s:L:v:c:p:Pe")) != -1) {
+        switch (opt) {
+        case 's':
+            params.shortTouchMs = atoi(optarg);
+            break;
+        case 'L':
+            params.longTouchMs = atoi(optarg);
+            break;
+        case 'v':
+            params.vsyncTouchMs = atoi(optarg);
+            break;
+        case 'c':
+            params.vsyncBoostCount = atoi(optarg);
+            break;
+        case 'p':
+            pulseMs = atoll(optarg);
+            break;
+        case 'P':
+            params.predictive = 1;
+            break;
+        case 'e':
+            events = true;
+            break;
+        default:
+            optind = argc + 1;
+            break;
+        }
+    }
+    if (optind != argc - 1) {
+        fprintf(stderr, "usage: %s [-s short_ms] [-L long_ms] [-v vsync_touch_ms] "
+                "[-c vsync_boost_count] [-p pulse_ms] [-P] [-e] capture\n", argv[0]);
+        return 1;
+    }
+    if (read_capture(argv[optind], &records, &count))
+        return 1;
+
+    replay(params, records, count, pulseMs * NSEC_PER_MSEC, events, &stats);
+    free(records);
+
+    printf("params: short=%d long=%d vsync_touch=%d vsync_boost_count=%d pulse=%lld predictive=%d\n",
+           params.shortTouchMs, params.longTouchMs, params.vsyncTouchMs,
+           params.vsyncBoostCount, pulseMs, params.predictive);
+    printf("hints=%u boosts=%u writes=%u boosted_ms=%lld missed_windows=%u missed_frames=%u missed_ms=%lld\n",
+           stats.hints, stats.pulses, stats.writes, stats.boostedNs / NSEC_PER_MSEC, stats.missedWindows,
+           stats.missedFrames, stats.missedNs / NSEC_PER_MSEC);
+    return 0;
+}
@@ -0,0 +1,285 @@
+/*
+ * Copyright (C) 2014 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Host benchmarks for the power HAL. The HAL sources are linked in and
+ * pointed at an in-memory sysfs (or a tmpfs tree with -r), so hint
+ * throughput and transition latency can be compared between builds.
+ * Exits nonzero if a staged screen-off leaves a device unsuspended.
+ *
+ *   power_bench [-g interactive|intel_pstate|schedutil] [-n iterations]
+ *               [-l write_latency_us] [-r root] [-t trace]
+ *
+ * A trace has one hint per line: "<t_us> <hint> <data>", where hint is
+ * interaction, vsync, low_power, sustained, launch (where the platform has
+ * the app launch hint) or a raw number.
+ */
+
+#include <dlfcn.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <hardware/hardware.h>
+#include <hardware/power.h>
+
+#include "BenchTree.h"
+#include "CGroupCpusetController.h"
+#include "DevicePowerMonitor.h"
+#include "FakeFs.h"
+#include "LatencyHistogram.h"
+#include "PowerFs.h"
+
+#define DEFAULT_ITERATIONS 100000
+#define TRANSITION_ITERATIONS 50
+
+static const int deviceCounts[] = { 1, 10, 100 };
+
+static FakeFs *fakeFs;
+static const char *treeRoot;
+
+static long long now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static power_hint_t parse_hint(const char *name)
+{
+    if (!strcmp(name, "interaction"))
+        return POWER_HINT_INTERACTION;
+    if (!strcmp(name, "vsync"))
+        return POWER_HINT_VSYNC;
+    if (!strcmp(name, "low_power"))
+        return POWER_HINT_LOW_POWER;
+    if (!strcmp(name, "sustained"))
+        return POWER_HINT_SUSTAINED_PERFORMANCE;
+#if defined(APP_LAUNCH_BOOST) && defined(APP_LAUNCH_BOOST_SUPPORTED)
+    if (!strcmp(name, "launch"))
+        return POWER_HINT_APP_LAUNCH;
+#endif
+    return (power_hint_t)strtol(name, NULL, 0);
+}
+
+static void bench_hints(struct power_module *module, int iterations)
+{
+    LatencyHistogram interactionHist("bench_interaction");
+    LatencyHistogram vsyncHist("bench_vsync");
+    long long start;
+    long long t;
+    int i;
+
+    start = now_ns();
+    for (i = 0; i < iterations; i++) {
+        t = now_ns();
+        module->powerHint(module, POWER_HINT_INTERACTION, NULL);
+        interactionHist.record(now_ns() - t);
+        t = now_ns();
+        module->powerHint(module, POWER_HINT_VSYNC, (void *)1);
+        vsyncHist.record(now_ns() - t);
+    }
+    t = now_ns() - start;
+    printf("hints: %d in %lld us, %.0f hints/s\n", 2 * iterations, t / 1000,
+           2.0 * iterations * 1e9 / t);
+    fflush(stdout);
+    interactionHist.dump(STDOUT_FILENO);
+    vsyncHist.dump(STDOUT_FILENO);
+}
+
+static void bench_transitions(void)
+{
+    CGroupCpusetController *cpuset;
+    DevicePowerMonitor *monitor;
+    LatencyHistogram *hist;
+    char name[32];
+    long long t;
+    size_t c;
+    int i;
+
+    for (c = 0; c < sizeof(deviceCounts) / sizeof(deviceCounts[0]); c++) {
+        bench_tree_set_devices(deviceCounts[c]);
+        snprintf(name, sizeof(name), "bench_devices_%d", deviceCounts[c]);
+        hist = new LatencyHistogram(name);
+        /* a fresh monitor so the initial scan sees the new inventory */
+        monitor = new DevicePowerMonitor();
+        monitor->setState(1);
+        monitor->waitIdle();
+        /* setState() returns before the background phases land; time the whole batch */
+        for (i = 0; i < TRANSITION_ITERATIONS; i++) {
+            t = now_ns();
+            monitor->setState(i & 1);
+            monitor->waitIdle();
+            hist->record(now_ns() - t);
+        }
+        hist->dump(STDOUT_FILENO);
+        /* the monitor owns listener and worker threads; leak it */
+        delete hist;
+    }
+
+    hist = new LatencyHistogram("bench_cpuset");
+    cpuset = new CGroupCpusetController();
+    cpuset->probe();
+    cpuset->setState(1);
+    for (i = 0; i < TRANSITION_ITERATIONS; i++) {
+        t = now_ns();
+        cpuset->setState(i & 1);
+        hist->record(now_ns() - t);
+    }
+    hist->dump(STDOUT_FILENO);
+    delete hist;
+    delete cpuset;
+}
+
+/*
+ * A screen-off whose stages all fire at once hands the devices stage and
+ * the critical stage to the monitor back to back. Every device has to
+ * end up suspended, not just the ones the workers reached first.
+ */
+static int bench_staged_suspend(void)
+{
+    int count = deviceCounts[sizeof(deviceCounts) / sizeof(deviceCounts[0]) - 1];
+    DevicePowerMonitor *monitor;
+    int failures = 0;
+    int suspended;
+    int i;
+
+    bench_tree_set_devices(count);
+    monitor = new DevicePowerMonitor();
+    for (i = 0; i < TRANSITION_ITERATIONS; i++) {
+        monitor->setState(1);
+        monitor->waitIdle();
+        monitor->setState(0, DevicePowerMonitorInfo::PHASE_NORMAL,
+                          DevicePowerMonitorInfo::PHASE_LATE);
+        monitor->setState(0, DevicePowerMonitorInfo::PHASE_CRITICAL,
+                          DevicePowerMonitorInfo::PHASE_CRITICAL);
+        monitor->waitIdle();
+        /* power_HAL_suspend holds 1 once a device is suspended */
+        suspended = bench_tree_count_devices("1");
+        if (suspended != count) {
+            fprintf(stderr, "staged suspend %d: %d of %d devices suspended\n",
+                    i, suspended, count);
+            failures++;
+        }
+    }
+    printf("staged suspend: %d devices, %d of %d runs complete\n", count,
+           TRANSITION_ITERATIONS - failures, TRANSITION_ITERATIONS);
+    /* the monitor owns listener and worker threads; leak it */
+    return failures;
+}
+
+static int replay_trace(struct power_module *module, const char *trace)
+{
+    LatencyHistogram replayHist("bench_replay");
+    char line[128];
+    char hint[32];
+    long long start;
+    long long at;
+    long long wait;
+    long data;
+    FILE *f;
+    int n = 0;
+
+    f = fopen(trace, "r");
+    if (f == NULL) {
+        fprintf(stderr, "cannot open %s: %s\n", trace, strerror(errno));
+        return -1;
+    }
+
+    start = now_ns();
+    while (fgets(line, sizeof(line), f)) {
+        if (line[0] == '#' || sscanf(line, "%lld %31s %ld", &at, hint, &data) != 3)
+            continue;
+        wait = start + at * 1000 - now_ns();
+        if (wait > 0)
+            usleep(wait / 1000);
+        at = now_ns();
+        module->powerHint(module, parse_hint(hint), (void *)data);
+        replayHist.record(now_ns() - at);
+        n++;
+    }
+    fclose(f);
+    printf("replay: %d hints\n", n);
+    fflush(stdout);
+    replayHist.dump(STDOUT_FILENO);
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    struct power_module *module;
+    const char *governor = "interactive";
+    const char *trace = NULL;
+    unsigned int latencyUs = 0;
+    int iterations = DEFAULT_ITERATIONS;
+    int failures;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "g:n:l:r:t:")) != -1) {
+        switch (opt) {
+        case 'g':
+            governor = optarg;
+            break;
+        case 'n':
+            iterations = atoi(optarg);
+            break;
+        case 'l':
+            latencyUs = atoi(optarg);
+            break;
+        case 'r':
+            treeRoot = optarg;
+            break;
+        case 't':
+            trace = optarg;
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-g interactive|intel_pstate|schedutil] [-n iterations] "
+                    "[-l write_latency_us] [-r root] [-t trace]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if (treeRoot) {
+        PowerFs::set(new PosixFs(treeRoot));
+    } else {
+        fakeFs = new FakeFs();
+        fakeFs->setWriteLatencyUs(latencyUs);
+        PowerFs::set(fakeFs);
+    }
+    bench_tree_init(fakeFs, treeRoot);
+    bench_tree_setup(governor);
+
+    module = (struct power_module *)dlsym(RTLD_DEFAULT, HAL_MODULE_INFO_SYM_AS_STR);
+    if (module == NULL) {
+        fprintf(stderr, "power module not linked in: %s\n", dlerror());
+        return 1;
+    }
+    module->init(module);
+
+    if (trace)
+        return replay_trace(module, trace) ? 1 : 0;
+
+    bench_hints(module, iterations);
+    bench_transitions();
+    failures = bench_staged_suspend();
+    if (fakeFs)
+        printf("fake fs writes: %llu\n", fakeFs->writes());
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,668 @@
+/*
+ * Copyright (C) 2014 Intel Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Scripted power/performance scenarios run end to end through the HAL
+ * module: scroll, fling, app cold launch, screen off/on cycles and idle.
+ * Every sysfs write the HAL makes is timestamped on its way to the
+ * backend, and package energy comes from RAPL, so a run scores both how
+ * fast boosts land and what they cost.
+ *
+ *   power_scenarios [-f governor | -r root -g governor] [-s list]
+ *                   [-c cycles] [-w screen_off_wait_ms] [-o results]
+ *                   [-b baseline] [-T tolerance_pct]
+ *
+ * Without -f or -r the HAL drives the real kernel; stop the power HAL
+ * service first so the two do not fight over the nodes, and run as root
+ * for RAPL. -f builds an in-memory tree for the governor, -r a tmpfs one.
+ * -s picks scenarios from idle,scroll,fling,cold_launch,screen_cycle;
+ * cold_launch needs a platform with the app launch hint and is skipped
+ * elsewhere, which the scoring treats as missing metrics.
+ *
+ * Results are "<scenario>.<metric> <value>" lines, one per metric, in a
+ * fixed order; "#" lines are comments. Given a baseline in the same
+ * format, score.perf and score.power are appended: the geometric mean of
+ * current/baseline over the latency metrics and over energy, boost
+ * residency and sysfs writes, as percent, with a 100us allowance on
+ * latencies. 100 means unchanged and lower is better. The exit status is 2 if either score is above
+ * 100 + tolerance (default 5).
+ */
+
+#include <dlfcn.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <map>
+#include <string>
+
+#include <hardware/hardware.h>
+#include <hardware/power.h>
+
+#include "BenchTree.h"
+#include "FakeFs.h"
+#include "PowerFs.h"
+#include "RecordingFs.h"
+
+#define RESULTS_FORMAT 2
+#define FRAME_US 16667
+#define SCROLL_MS 1000
+#define FLING_TOUCH_MS 100
+#define FLING_TAIL_MS 700
+#define LAUNCH_MS 800
+#define IDLE_MS 2000
+#define DEFAULT_CYCLES 3
+/* past the last default screen-off stage */
+#define DEFAULT_SCREEN_OFF_WAIT_MS 6000
+/* the HAL is settled once it has not written for this long */
+#define QUIET_MS 300
+#define SETTLE_TIMEOUT_MS 10000
+#define DEFAULT_TOLERANCE_PCT 5
+
+#define RAPL_DIR "/sys/class/powercap"
+#define RAPL_MAX_ZONES 16
+
+#define NSEC_PER_MSEC 1000000LL
+#define NSEC_PER_USEC 1000LL
+
+static struct power_module *module;
+static RecordingFs *recorder;
+static FILE *out;
+/* metrics of this run, for scoring against the baseline */
+static std::map<std::string, double> results;
+
+/*
+ * RAPL energy counters. They are read from the kernel even when the HAL
+ * runs on a fake tree: energy is only meaningful on the real package.
+ */
+struct RaplZone {
+    char name[32];
+    char path[PATH_MAX];
+    long long maxUj;
+    bool package;
+};
+static RaplZone raplZones[RAPL_MAX_ZONES];
+static int numRaplZones;
+
+/* hint call statistics for the running scenario */
+struct HintStats {
+    unsigned int count;
+    long long sumNs;
+    long long maxNs;
+};
+
+struct Scenario {
+    const char *name;
+    void (*run)(const char *name);
+};
+
+static long long read_ll(const char *path)
+{
+    char buf[32];
+    ssize_t len;
+    int fd;
+
+    fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return -1;
+    len = read(fd, buf, sizeof(buf) - 1);
+    close(fd);
+    if (len <= 0)
+        return -1;
+    buf[len] = '\0';
+    return atoll(buf);
+}
+
+static void rapl_add_zone(const char *dir)
+{
+    RaplZone *z = &raplZones[numRaplZones];
+    char path[PATH_MAX];
+    char *p;
+    ssize_t len;
+    int fd;
+
+    snprintf(path, sizeof(path), "%s/energy_uj", dir);
+    if (numRaplZones >= RAPL_MAX_ZONES || read_ll(path) < 0)
+        return;
+    snprintf(z->path, sizeof(z->path), "%s", path);
+    snprintf(path, sizeof(path), "%s/max_energy_range_uj", dir);
+    z->maxUj = read_ll(path);
+
+    snprintf(path, sizeof(path), "%s/name", dir);
+    z->name[0] = '\0';
+    fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd >= 0) {
+        len = read(fd, z->name, sizeof(z->name) - 1);
+        z->name[len > 0 ? len : 0] = '\0';
+        close(fd);
+    }
+    /* metric names: "package-0\n" becomes package_0 */
+    for (p = z->name; *p; p++) {
+        if (*p == '\n') {
+            *p = '\0';
+            break;
+        }
+        if (*p == '-' || *p == ' ')
+            *p = '_';
+    }
+    if (!z->name[0])
+        snprintf(z->name, sizeof(z->name), "zone%d", numRaplZones);
+    z->package = !strncmp(z->name, "package", 7);
+    numRaplZones++;
+}
+
+static void rapl_probe(void)
+{
+    char dir[PATH_MAX];
+    int i, j;
+
+    for (i = 0; i < RAPL_MAX_ZONES; i++) {
+        snprintf(dir, sizeof(dir), "%s/intel-rapl:%d", RAPL_DIR, i);
+        if (access(dir, F_OK))
+            break;
+        rapl_add_zone(dir);
+        for (j = 0; j < RAPL_MAX_ZONES; j++) {
+            snprintf(dir, sizeof(dir), "%s/intel-rapl:%d:%d", RAPL_DIR, i, j);
+            if (access(dir, F_OK))
+                break;
+            rapl_add_zone(dir);
+        }
+    }
+}
+
+static void rapl_read(long long *uj)
+{
+    int i;
+
+    for (i = 0; i < numRaplZones; i++)
+        uj[i] = read_ll(raplZones[i].path);
+}
+
+static long long now_ns(void)
+{
+    return RecordingFs::now();
+}
+
+static void sleep_until(long long deadline)
+{
+    long long wait = deadline - now_ns();
+
+    if (wait > 0)
+        usleep(wait / NSEC_PER_USEC);
+}
+
+/* wait for the HAL to stop writing, e.g. for leases to run out */
+static void wait_quiet(void)
+{
+    long long start = now_ns();
+    long long last;
+
+    while (now_ns() - start < SETTLE_TIMEOUT_MS * NSEC_PER_MSEC) {
+        last = recorder->lastWriteNs();
+        if (now_ns() - (last > start ? last : start) >= QUIET_MS * NSEC_PER_MSEC)
+            return;
+        usleep(QUIET_MS * 1000 / 4);
+    }
+}
+
+static void hint(HintStats *stats, power_hint_t h, long data)
+{
+    long long t = now_ns();
+
+    module->powerHint(module, h, (void *)data);
+    t = now_ns() - t;
+    stats->count++;
+    stats->sumNs += t;
+    if (t > stats->maxNs)
+        stats->maxNs = t;
+}
+
+static void metric(const char *scenario, const char *name, double value)
+{
+    char key[128];
+
+    snprintf(key, sizeof(key), "%s.%s", scenario, name);
+    results[key] = value;
+    if (value == floor(value))
+        fprintf(out, "%s %.0f\n", key, value);
+    else
+        fprintf(out, "%s %.2f\n", key, value);
+}
+
+/*
+ * Common bracket of a scenario: start from a quiet HAL, then report the
+ * hint cost, how fast the first boost landed after start, how long any
+ * boost was on, the writes and the energy until the HAL went quiet again.
+ */
+struct Run {
+    const char *name;
+    long long startNs;
+    long long uj[RAPL_MAX_ZONES];
+    RecordingFs::Snapshot before;
+    HintStats hints;
+};
+
+static void run_begin(Run *run, const char *name)
+{
+    wait_quiet();
+    memset(run, 0, sizeof(*run));
+    run->name = name;
+    recorder->snapshot(&run->before);
+    recorder->arm();
+    rapl_read(run->uj);
+    run->startNs = now_ns();
+}
+
+static void run_end(Run *run)
+{
+    RecordingFs::Snapshot after;
+    long long uj[RAPL_MAX_ZONES];
+    long long durationNs;
+    long long delta;
+    long long packageUj = -1;
+    char name[64];
+    int i;
+
+    wait_quiet();
+    recorder->snapshot(&after);
+    rapl_read(uj);
+    durationNs = now_ns() - run->startNs;
+
+    metric(run->name, "duration_ms", durationNs / NSEC_PER_MSEC);
+    metric(run->name, "hints", run->hints.count);
+    metric(run->name, "hint_avg_us", run->hints.count ?
+           run->hints.sumNs / run->hints.count / NSEC_PER_USEC : 0);
+    metric(run->name, "hint_max_us", run->hints.maxNs / NSEC_PER_USEC);
+    metric(run->name, "time_to_boost_us", after.firstBoostNs ?
+           (after.firstBoostNs - run->startNs) / NSEC_PER_USEC : -1);
+    metric(run->name, "boost_residency_pct",
+           floor(1000.0 * (after.boostedNs - run->before.boostedNs) / durationNs) / 10);
+    metric(run->name, "pulses", after.pulses - run->before.pulses);
+    metric(run->name, "sysfs_writes", after.writes - run->before.writes);
+    metric(run->name, "boost_writes", after.classWrites[RecordingFs::NODE_BOOST] -
+           run->before.classWrites[RecordingFs::NODE_BOOST]);
+    metric(run->name, "cpuset_writes", after.classWrites[RecordingFs::NODE_CPUSET] -
+           run->before.classWrites[RecordingFs::NODE_CPUSET]);
+    metric(run->name, "epp_writes", after.classWrites[RecordingFs::NODE_EPP] -
+           run->before.classWrites[RecordingFs::NODE_EPP]);
+    metric(run->name, "device_writes", after.classWrites[RecordingFs::NODE_DEVICE] -
+           run->before.classWrites[RecordingFs::NODE_DEVICE]);
+
+    for (i = 0; i < numRaplZones; i++) {
+        if (uj[i] < 0 || run->uj[i] < 0)
+            continue;
+        delta = uj[i] - run->uj[i];
+        /* the counter wraps at max_energy_range_uj */
+        if (delta < 0 && raplZones[i].maxUj > 0)
+            delta += raplZones[i].maxUj;
+        if (raplZones[i].package)
+            packageUj = (packageUj < 0 ? 0 : packageUj) + delta;
+        snprintf(name, sizeof(name), "energy_%s_uj", raplZones[i].name);
+        metric(run->name, name, delta);
+    }
+    metric(run->name, "energy_uj", packageUj);
+    metric(run->name, "avg_power_mw", packageUj < 0 ? -1 :
+           floor(packageUj * 1000000.0 / durationNs));
+}
+
+static void scenario_idle(const char *name)
+{
+    Run run;
+
+    run_begin(&run, name);
+    sleep_until(run.startNs + IDLE_MS * NSEC_PER_MSEC);
+    run_end(&run);
+}
+
+/* a drag: one interaction and one frame request per vsync */
+static void scenario_scroll(const char *name)
+{
+    Run run;
+    long long t;
+
+    run_begin(&run, name);
+    for (t = 0; t < SCROLL_MS * 1000LL; t += FRAME_US) {
+        sleep_until(run.startNs + t * NSEC_PER_USEC);
+        hint(&run.hints, POWER_HINT_INTERACTION, 0);
+        hint(&run.hints, POWER_HINT_VSYNC, 1);
+    }
+    hint(&run.hints, POWER_HINT_VSYNC, 0);
+    run_end(&run);
+}
+
+/* a short touch, then frames keep coming while the list flies on */
+static void scenario_fling(const char *name)
+{
+    Run run;
+    long long t;
+
+    run_begin(&run, name);
+    for (t = 0; t < (FLING_TOUCH_MS + FLING_TAIL_MS) * 1000LL; t += FRAME_US) {
+        sleep_until(run.startNs + t * NSEC_PER_USEC);
+        if (t < FLING_TOUCH_MS * 1000LL)
+            hint(&run.hints, POWER_HINT_INTERACTION, 0);
+        hint(&run.hints, POWER_HINT_VSYNC, 1);
+    }
+    hint(&run.hints, POWER_HINT_VSYNC, 0);
+    run_end(&run);
+}
+
+#if defined(APP_LAUNCH_BOOST) && defined(APP_LAUNCH_BOOST_SUPPORTED)
+static void scenario_cold_launch(const char *name)
+{
+    Run run;
+
+    run_begin(&run, name);
+    hint(&run.hints, POWER_HINT_APP_LAUNCH, 1);
+    sleep_until(run.startNs + LAUNCH_MS * NSEC_PER_MSEC);
+    hint(&run.hints, POWER_HINT_APP_LAUNCH, 0);
+    run_end(&run);
+}
+#else
+/* no launch hint on this platform; the scenario reports nothing */
+#define scenario_cold_launch NULL
+#endif
+
+static int screenCycles = DEFAULT_CYCLES;
+static int screenOffWaitMs = DEFAULT_SCREEN_OFF_WAIT_MS;
+
+/*
+ * Screen off until every stage has run, then on. Besides the common
+ * metrics: the cost of the set_interactive calls, when the first stage
+ * and the last screen-off write landed, and how long the resume took.
+ */
+static void scenario_screen_cycle(const char *name)
+{
+    RecordingFs::Snapshot s;
+    Run run;
+    long long offCallNs = 0, onCallNs = 0;
+    long long firstStageNs = 0, offSettleNs = 0, resumeNs = 0;
+    long long first;
+    long long t;
+    int firstStages = 0;
+    int i;
+
+    run_begin(&run, name);
+    for (i = 0; i < screenCycles; i++) {
+        recorder->arm();
+        t = now_ns();
+        module->setInteractive(module, 0);
+        offCallNs += now_ns() - t;
+        sleep_until(t + screenOffWaitMs * NSEC_PER_MSEC);
+        recorder->snapshot(&s);
+        /* the first stage writes the cpuset and EPP profiles; take whichever landed first */
+        first = s.firstClassNs[RecordingFs::NODE_CPUSET];
+        if (s.firstClassNs[RecordingFs::NODE_EPP] &&
+                (!first || s.firstClassNs[RecordingFs::NODE_EPP] < first))
+            first = s.firstClassNs[RecordingFs::NODE_EPP];
+        if (first) {
+            firstStageNs += first - t;
+            firstStages++;
+        }
+        if (s.lastWriteNs > t)
+            offSettleNs += s.lastWriteNs - t;
+
+        t = now_ns();
+        module->setInteractive(module, 1);
+        onCallNs += now_ns() - t;
+        wait_quiet();
+        recorder->snapshot(&s);
+        if (s.lastWriteNs > t)
+            resumeNs += s.lastWriteNs - t;
+    }
+    /* the time to boost of a screen cycle is meaningless */
+    recorder->arm();
+    run_end(&run);
+
+    metric(name, "cycles", screenCycles);
+    metric(name, "off_call_us", offCallNs / screenCycles / NSEC_PER_USEC);
+    metric(name, "on_call_us", onCallNs / screenCycles / NSEC_PER_USEC);
+    metric(name, "off_first_stage_ms", firstStages ?
+           firstStageNs / firstStages / NSEC_PER_MSEC : -1);
+    metric(name, "off_settle_ms", offSettleNs / screenCycles / NSEC_PER_MSEC);
+    metric(name, "on_resume_us", resumeNs / screenCycles / NSEC_PER_USEC);
+}
+
+static const Scenario scenarios[] = {
+    { "idle", scenario_idle },
+    { "scroll", scenario_scroll },
+    { "fling", scenario_fling },
+    { "cold_launch", scenario_cold_launch },
+    { "screen_cycle", scenario_screen_cycle },
+};
+
+/*
+ * Metrics that are scored; lower is better for all of them. Latencies
+ * get an allowance so scheduling jitter of a few microseconds does not
+ * read as a regression.
+ */
+#define SCORE_PERF 1
+#define SCORE_POWER 2
+static const struct {
+    const char *suffix;
+    int kind;
+    double allowance;
+} scoredMetrics[] = {
+    { ".time_to_boost_us", SCORE_PERF, 100 },
+    { ".hint_avg_us", SCORE_PERF, 100 },
+    { ".off_call_us", SCORE_PERF, 100 },
+    { ".on_call_us", SCORE_PERF, 100 },
+    { ".on_resume_us", SCORE_PERF, 100 },
+    { ".energy_uj", SCORE_POWER, 0 },
+    { ".boost_residency_pct", SCORE_POWER, 0 },
+    { ".sysfs_writes", SCORE_POWER, 0 },
+};
+
+/* index into scoredMetrics, -1 for informational metrics */
+static int scored_metric(const char *metric)
+{
+    size_t len = strlen(metric);
+    size_t i, n;
+
+    for (i = 0; i < sizeof(scoredMetrics) / sizeof(scoredMetrics[0]); i++) {
+        n = strlen(scoredMetrics[i].suffix);
+        if (len > n && !strcmp(metric + len - n, scoredMetrics[i].suffix))
+            return i;
+    }
+    return -1;
+}
+
+/*
+ * Scores against a baseline run. Metrics missing on either side (-1,
+ * e.g. no RAPL) or zero in the baseline are left out. Returns the exit
+ * status.
+ */
+static int score(const char *baseline, int tolerancePct)
+{
+    std::map<std::string, double>::iterator it;
+    double logPerf = 0, logPower = 0;
+    double perf, power, base, ratio;
+    int nPerf = 0, nPower = 0;
+    int format;
+    int m;
+    char line[256];
+    char key[128];
+    FILE *f;
+
+    f = fopen(baseline, "r");
+    if (f == NULL) {
+        fprintf(stderr, "cannot open %s: %s\n", baseline, strerror(errno));
+        return 1;
+    }
+    fprintf(stderr, "%-40s %12s %12s %8s\n", "metric", "baseline", "current", "change");
+    while (fgets(line, sizeof(line), f)) {
+        /* the scored metrics are the same across formats, the per-class counts are not */
+        if (sscanf(line, "# power_scenarios format %d", &format) == 1 && format != RESULTS_FORMAT)
+            fprintf(stderr, "baseline is format %d, this run format %d\n", format, RESULTS_FORMAT);
+        if (line[0] == '#' || sscanf(line, "%127s %lf", key, &base) != 2)
+            continue;
+        it = results.find(key);
+        if (it == results.end() || base <= 0 || it->second < 0)
+            continue;
+        m = scored_metric(key);
+        if (m < 0)
+            continue;
+        /* a metric that went to 0 counts as one unit so the log stays finite */
+        ratio = ((it->second > 0 ? it->second : 1) + scoredMetrics[m].allowance) /
+                (base + scoredMetrics[m].allowance);
+        if (scoredMetrics[m].kind == SCORE_PERF) {
+            logPerf += log(ratio);
+            nPerf++;
+        } else {
+            logPower += log(ratio);
+            nPower++;
+        }
+        fprintf(stderr, "%-40s %12.2f %12.2f %+7.1f%%\n", key, base, it->second,
+                (it->second - base) * 100 / base);
+    }
+    fclose(f);
+
+    perf = nPerf ? 100 * exp(logPerf / nPerf) : 100;
+    power = nPower ? 100 * exp(logPower / nPower) : 100;
+    fprintf(out, "score.perf %.1f\n", perf);
+    fprintf(out, "score.power %.1f\n", power);
+    fprintf(stderr, "perf score %.1f, power score %.1f (100 = baseline, lower is better)\n",
+            perf, power);
+    return perf > 100 + tolerancePct || power > 100 + tolerancePct ? 2 : 0;
+}
+
+static bool selected(const char *list, const char *name)
+{
+    const char *p = list;
+    size_t len = strlen(name);
+
+    if (list == NULL)
+        return true;
+    while ((p = strstr(p, name)) != NULL) {
+        if ((p == list || p[-1] == ',') && (p[len] == ',' || p[len] == '\0'))
+            return true;
+        p += len;
+    }
+    return false;
+}
+
+int main(int argc, char **argv)
+{
+    const char *governor = NULL;
+    const char *treeRoot = NULL;
+    const char *list = NULL;
+    const char *outPath = NULL;
+    const char *baseline = NULL;
+    int tolerancePct = DEFAULT_TOLERANCE_PCT;
+    FakeFs *fakeFs = NULL;
+    PowerFs *backend;
+    size_t i;
+    int opt;
+    int ret = 0;
+
+    while ((opt = getopt(argc, argv, "f:g:r:s:c:w:o:b:T:")) != -1) {
+        switch (opt) {
+        case 'f':
+            fakeFs = new FakeFs();
+            governor = optarg;
+            break;
+        case 'g':
+            governor = optarg;
+            break;
+        case 'r':
+            treeRoot = optarg;
+            break;
+        case 's':
+            list = optarg;
+            break;
+        case 'c':
+            screenCycles = atoi(optarg) > 0 ? atoi(optarg) : 1;
+            break;
+        case 'w':
+            screenOffWaitMs = atoi(optarg);
+            break;
+        case 'o':
+            outPath = optarg;
+            break;
+        case 'b':
+            baseline = optarg;
+            break;
+        case 'T':
+            tolerancePct = atoi(optarg);
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-f governor | -r root -g governor] [-s list] "
+                    "[-c cycles] [-w screen_off_wait_ms] [-o results] [-b baseline] "
+                    "[-T tolerance_pct]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    out = stdout;
+    if (outPath && (out = fopen(outPath, "w")) == NULL) {
+        fprintf(stderr, "cannot create %s: %s\n", outPath, strerror(errno));
+        return 1;
+    }
+
+    /* the HAL only ever sees the recorder, installed before power_init */
+    if (fakeFs)
+        backend = fakeFs;
+    else if (treeRoot)
+        backend = new PosixFs(treeRoot);
+    else
+        backend = new PosixFs();
+    if (fakeFs || treeRoot) {
+        bench_tree_init(fakeFs, treeRoot);
+        bench_tree_setup(governor ? governor : "interactive");
+    }
+    recorder = new RecordingFs(backend);
+    PowerFs::set(recorder);
+    rapl_probe();
+
+    module = (struct power_module *)dlsym(RTLD_DEFAULT, HAL_MODULE_INFO_SYM_AS_STR);
+    if (module == NULL) {
+        fprintf(stderr, "power module not linked in: %s\n", dlerror());
+        return 1;
+    }
+
+    fprintf(out, "# power_scenarios format %d\n", RESULTS_FORMAT);
+    fprintf(out, "# backend %s governor %s rapl_zones %d\n",
+            fakeFs ? "fake" : treeRoot ? "tree" : "kernel",
+            governor ? governor : "-", numRaplZones);
+    fflush(out);
+
+    /* the screen is on from here, as after boot */
+    module->init(module);
+    module->setInteractive(module, 1);
+
+    for (i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]); i++) {
+        if (!selected(list, scenarios[i].name))
+            continue;
+        if (scenarios[i].run == NULL) {
+            fprintf(out, "# %s skipped, not supported by this build\n", scenarios[i].name);
+            continue;
+        }
+        scenarios[i].run(scenarios[i].name);
+        fflush(out);
+    }
+
+    if (baseline)
+        ret = score(baseline, tolerancePct);
+    if (out != stdout)
+        fclose(out);
+    return ret;
+}
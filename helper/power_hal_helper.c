@@ -20,55 +20,234 @@
 #include <ctype.h>
 #include <dirent.h>
 #include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/socket.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <unistd.h>
+
+#include <linux/cn_proc.h>
+#include <linux/connector.h>
+#include <linux/netlink.h>
 
 #include <cutils/log.h>
 #include <cutils/properties.h>
 #include <errno.h>
 
-static const char* PROPERTY_NON_INTERACTIVE_PROC = "sys.power_hal.niproc";
+/*
+ * Long-lived helper that keeps a configured set of processes in their
+ * cpusets. Process exec/exit events come from the proc connector, so a
+ * restarted daemon is placed again as soon as it execs; /proc is only
+ * walked at startup and after the event socket overflowed.
+ *
+ * ro.powerhal.helper.procs overrides the tracked list as a comma
+ * separated list of "<argv[0]>=<cpuset>" entries.
+ */
+static const char* PROPERTY_HELPER_PROCS = "ro.powerhal.helper.procs";
+static const char* DEFAULT_HELPER_PROCS = "/system/bin/mediaserver=non_interactive";
+static const char* CPUSET_PROCS_FMT = "/dev/cpuset/%s/cgroup.procs";
 
-#define PROCESS_NAME_LEN 32
+#define PROCESS_NAME_LEN 64
+#define CPUSET_NAME_LEN 32
+#define MAX_PROCESSES 32
+#define MAX_CPUSETS 8
+/* power of two, at least twice MAX_PROCESSES */
+#define NAME_HASH_SIZE 64
+#define MAX_PENDING 64
 
 struct process_pid_t {
     char name[PROCESS_NAME_LEN];
+    int cpuset;
     pid_t pid;
 };
 
-static struct process_pid_t s_pids[] = {
-    { "/system/bin/mediaserver", -1 },
-    { "", -1 }
+struct cpuset_t {
+    char name[CPUSET_NAME_LEN];
+    int fd;
 };
 
-/* Set a property so that init can write the PID to correct files */
-static void notify_pid(pid_t pid)
+static struct process_pid_t s_pids[MAX_PROCESSES];
+static int s_num_pids;
+static struct cpuset_t s_cpusets[MAX_CPUSETS];
+static int s_num_cpusets;
+/* name -> index into s_pids, -1 when empty; open addressing */
+static int s_name_hash[NAME_HASH_SIZE];
+
+/* moves collected while draining one burst of events */
+static int s_pending[MAX_PENDING];
+static int s_num_pending;
+
+static unsigned int name_hash(const char *name)
 {
-    int fd;
-    int ret;
-    char str[10];
-
-    ret = snprintf(str, sizeof(str), "%d", pid);
-    if (ret > 0) {
-        ret = property_set(PROPERTY_NON_INTERACTIVE_PROC, str);
-        if (ret < 0) {
-            ALOGV("cannot set property\n");
+    unsigned int h = 5381;
+
+    while (*name)
+        h = h * 33 + (unsigned char)*name++;
+    return h & (NAME_HASH_SIZE - 1);
+}
+
+static struct process_pid_t *lookup_process(const char *name)
+{
+    unsigned int h = name_hash(name);
+    int i;
+
+    for (i = 0; i < NAME_HASH_SIZE; i++) {
+        int idx = s_name_hash[(h + i) & (NAME_HASH_SIZE - 1)];
+        if (idx < 0)
+            return NULL;
+        if (strcmp(s_pids[idx].name, name) == 0)
+            return &s_pids[idx];
+    }
+    return NULL;
+}
+
+static int cpuset_index(const char *name)
+{
+    char path[80];
+    int i;
+
+    for (i = 0; i < s_num_cpusets; i++)
+        if (strcmp(s_cpusets[i].name, name) == 0)
+            return i;
+    if (s_num_cpusets >= MAX_CPUSETS)
+        return -1;
+
+    /* keep the group open: every placement is then a single write */
+    snprintf(path, sizeof(path), CPUSET_PROCS_FMT, name);
+    s_cpusets[i].fd = open(path, O_WRONLY | O_CLOEXEC);
+    if (s_cpusets[i].fd < 0) {
+        ALOGE("helper cannot open %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    snprintf(s_cpusets[i].name, sizeof(s_cpusets[i].name), "%s", name);
+    return s_num_cpusets++;
+}
+
+static void add_process(const char *name, const char *cpuset)
+{
+    struct process_pid_t *p;
+    unsigned int h;
+    int idx;
+
+    if (s_num_pids >= MAX_PROCESSES || strlen(name) >= PROCESS_NAME_LEN) {
+        ALOGE("helper cannot track %s\n", name);
+        return;
+    }
+    if (lookup_process(name))
+        return;
+    idx = cpuset_index(cpuset);
+    if (idx < 0)
+        return;
+
+    p = &s_pids[s_num_pids];
+    snprintf(p->name, sizeof(p->name), "%s", name);
+    p->cpuset = idx;
+    p->pid = -1;
+
+    h = name_hash(name);
+    while (s_name_hash[h] >= 0)
+        h = (h + 1) & (NAME_HASH_SIZE - 1);
+    s_name_hash[h] = s_num_pids++;
+}
+
+static void load_processes(void)
+{
+    char value[PROPERTY_VALUE_MAX];
+    char *entry, *save, *eq;
+
+    memset(s_name_hash, -1, sizeof(s_name_hash));
+    property_get(PROPERTY_HELPER_PROCS, value, DEFAULT_HELPER_PROCS);
+
+    for (entry = strtok_r(value, ",", &save); entry; entry = strtok_r(NULL, ",", &save)) {
+        eq = strchr(entry, '=');
+        if (!eq || eq == entry || !eq[1]) {
+            ALOGE("helper ignores malformed entry %s\n", entry);
+            continue;
         }
+        *eq = '\0';
+        add_process(entry, eq + 1);
     }
 }
 
+/* argv[0] of pid, or an empty string when it cannot be read */
+static void read_process_name(pid_t pid, char *name, size_t len)
+{
+    char cmdline[32];
+    ssize_t n;
+    int fd;
+
+    name[0] = '\0';
+    snprintf(cmdline, sizeof(cmdline), "/proc/%d/cmdline", pid);
+    fd = open(cmdline, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return;
+    n = read(fd, name, len - 1);
+    close(fd);
+    name[n > 0 ? n : 0] = '\0';
+}
+
+static void queue_move(struct process_pid_t *p, pid_t pid)
+{
+    p->pid = pid;
+    ALOGV("Found %s (%d)\n", p->name, p->pid);
+    if (s_num_pending < MAX_PENDING)
+        s_pending[s_num_pending++] = p - s_pids;
+}
+
+/*
+ * cgroup.procs takes one TGID per write, so batching means writing a
+ * whole burst back to back through the already open group files.
+ */
+static void flush_moves(void)
+{
+    char str[12];
+    int i, len;
+
+    for (i = 0; i < s_num_pending; i++) {
+        struct process_pid_t *p = &s_pids[s_pending[i]];
+
+        if (p->pid < 0)
+            continue;
+        len = snprintf(str, sizeof(str), "%d", p->pid);
+        if (write(s_cpusets[p->cpuset].fd, str, len) < 0)
+            ALOGV("cannot move %d to %s: %s\n", p->pid, s_cpusets[p->cpuset].name,
+                  strerror(errno));
+    }
+    s_num_pending = 0;
+}
+
+static void handle_exec(pid_t pid)
+{
+    char name[PROCESS_NAME_LEN];
+    struct process_pid_t *p;
+
+    read_process_name(pid, name, sizeof(name));
+    if (name[0] == '\0')
+        return;
+    p = lookup_process(name);
+    if (p)
+        queue_move(p, pid);
+}
+
+static void handle_exit(pid_t pid)
+{
+    int i;
+
+    for (i = 0; i < s_num_pids; i++)
+        if (s_pids[i].pid == pid) {
+            ALOGV("%s (%d) exited\n", s_pids[i].name, pid);
+            s_pids[i].pid = -1;
+        }
+}
+
 void cgroup_walk_proc_for_processes()
 {
     DIR *d;
     struct dirent *de;
-    int pid;
-    char cmdline[128];
-    char process_name[PROCESS_NAME_LEN];
-    int fd;
-    struct process_pid_t *p;
-    int cnt = 0, total_cnt = 0;
+    int cnt = 0;
 
     d = opendir("/proc");
     if (d == 0) {
@@ -76,62 +255,137 @@ void cgroup_walk_proc_for_processes()
         return;
     }
 
-    /* should look for # of processes */
-    p = &s_pids[0];
-    while (p->name[0] != '\0') {
-        if (p->pid == -1) {
-            total_cnt++;
-        }
-        p++;
-    };
-
-    /* walk through /proc */
     /* part of code is from /system/core/toolbox/ps.c */
-    while ((de = readdir(d)) != 0){
+    while ((de = readdir(d)) != 0) {
         /* only care about numbered directories */
-        if (isdigit(de->d_name[0])){
-            pid = atoi(de->d_name);
-
-            snprintf(cmdline, sizeof(cmdline), "/proc/%d/cmdline", pid);
-
-            /* match process name */
-            fd = open(cmdline, O_RDONLY);
-            if (fd >= 0) {
-                if (read(fd, process_name, sizeof(process_name)) > 0) {
-                    p = &s_pids[0];
-                    while (p->name[0] != '\0') {
-                        if ((p->pid == -1) &&
-                            (strncmp(process_name, p->name, sizeof(process_name)) == 0)) {
-
-                            p->pid = pid;
-                            cnt++;
-
-                            ALOGV("Found %s (%d)\n", p->name, p->pid);
-                            notify_pid(p->pid);
-                        }
-                        p++;
-                    }
-                }
-
-                close(fd);
-            }
-        }
+        if (isdigit(de->d_name[0])) {
+            int before = s_num_pending;
 
-        /* found enough */
-        if (cnt >= total_cnt) {
-            break;
+            handle_exec(atoi(de->d_name));
+            cnt += s_num_pending - before;
+            if (s_num_pending >= MAX_PENDING)
+                flush_moves();
         }
     }
-
     closedir(d);
+    flush_moves();
 
     ALOGV("helper found %d processes\n", cnt);
 }
 
+static int proc_connector_open(void)
+{
+    struct sockaddr_nl sa;
+    struct {
+        struct nlmsghdr hdr;
+        struct cn_msg msg;
+        enum proc_cn_mcast_op op;
+    } __attribute__((packed)) req;
+    int sock;
+
+    sock = socket(PF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC, NETLINK_CONNECTOR);
+    if (sock < 0)
+        return -1;
+
+    memset(&sa, 0, sizeof(sa));
+    sa.nl_family = AF_NETLINK;
+    sa.nl_groups = CN_IDX_PROC;
+    sa.nl_pid = getpid();
+    if (bind(sock, (struct sockaddr *)&sa, sizeof(sa)) < 0)
+        goto err;
+
+    memset(&req, 0, sizeof(req));
+    req.hdr.nlmsg_len = sizeof(req);
+    req.hdr.nlmsg_type = NLMSG_DONE;
+    req.hdr.nlmsg_pid = getpid();
+    req.msg.id.idx = CN_IDX_PROC;
+    req.msg.id.val = CN_VAL_PROC;
+    req.msg.len = sizeof(req.op);
+    req.op = PROC_CN_MCAST_LISTEN;
+    if (send(sock, &req, sizeof(req), 0) < 0)
+        goto err;
+    return sock;
+
+err:
+    close(sock);
+    return -1;
+}
+
+/* returns the number of bytes received, 0 when drained, -1 on error */
+static int handle_events(int sock, int flags)
+{
+    char buf[4096] __attribute__((aligned(NLMSG_ALIGNTO)));
+    struct nlmsghdr *hdr;
+    ssize_t len;
+
+    len = recv(sock, buf, sizeof(buf), flags);
+    if (len < 0) {
+        if (errno == EAGAIN || errno == EINTR)
+            return 0;
+        if (errno == ENOBUFS) {
+            /* events were dropped; catch up with a full walk */
+            ALOGE("helper lost process events, rescanning\n");
+            flush_moves();
+            cgroup_walk_proc_for_processes();
+            return 0;
+        }
+        return -1;
+    }
+
+    for (hdr = (struct nlmsghdr *)buf; NLMSG_OK(hdr, (size_t)len); hdr = NLMSG_NEXT(hdr, len)) {
+        struct cn_msg *msg = (struct cn_msg *)NLMSG_DATA(hdr);
+        struct proc_event *ev = (struct proc_event *)msg->data;
+
+        if (hdr->nlmsg_type != NLMSG_DONE || msg->id.idx != CN_IDX_PROC)
+            continue;
+        /* only process leaders are tracked; threads follow via cgroup.procs */
+        if (ev->what == PROC_EVENT_EXEC &&
+                ev->event_data.exec.process_pid == ev->event_data.exec.process_tgid)
+            handle_exec(ev->event_data.exec.process_tgid);
+        else if (ev->what == PROC_EVENT_EXIT &&
+                ev->event_data.exit.process_pid == ev->event_data.exit.process_tgid)
+            handle_exit(ev->event_data.exit.process_tgid);
+    }
+    return 1;
+}
+
 int main()
 {
-    /* find all interesting processes */
+    struct pollfd pfd;
+    int sock;
+
+    load_processes();
+    if (s_num_pids == 0)
+        return 0;
+
+    /* subscribe before the walk so nothing exec'd in between is missed */
+    sock = proc_connector_open();
     cgroup_walk_proc_for_processes();
+    if (sock < 0) {
+        ALOGE("helper cannot listen to process events: %s\n", strerror(errno));
+        return 0;
+    }
 
+    pfd.fd = sock;
+    pfd.events = POLLIN;
+    while (1) {
+        if (poll(&pfd, 1, -1) < 0) {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+        /* drain the whole burst, then place everything found in one pass */
+        while (s_num_pending < MAX_PENDING) {
+            int ret = handle_events(sock, MSG_DONTWAIT);
+            if (ret < 0)
+                goto out;
+            if (ret == 0)
+                break;
+        }
+        flush_moves();
+    }
+out:
+    ALOGE("helper stops listening to process events: %s\n", strerror(errno));
+    close(sock);
     return 0;
 }
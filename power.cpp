@@ -14,6 +14,8 @@
  * limitations under the License.
  */
 #include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -21,6 +23,7 @@
 #include <sys/un.h>
 
 #include <pthread.h>
+#include <atomic>
 
 #include <hardware/power.h>
 #include <fcntl.h>
@@ -31,348 +34,1000 @@
 #include <cutils/log.h>
 #include <cutils/properties.h>
 #include <hardware/hardware.h>
-#include <semaphore.h>
+#include "AdaptiveBoostController.h"
+#include "BoostArbiter.h"
+#include "BoostScheduler.h"
+#include "CGroupBoostController.h"
 #include "CGroupCpusetController.h"
 #include "DevicePowerMonitor.h"
+#include "EppController.h"
+#include "GovernorBackend.h"
+#include "GpuBoostController.h"
+#include "HintCoalescer.h"
+#include "HintRecorder.h"
+#include "LatencyHistogram.h"
+#include "PowerFs.h"
+#include "PowerHal.h"
+#include "PowerTunables.h"
+#include "ScreenStateController.h"
+#include "SysfsActuator.h"
+#include "SustainedController.h"
+#include "SysfsNode.h"
+#include "TouchClassifier.h"
+#include "TouchPredictor.h"
 
 #define ENABLE 1
-#define TOUCHBOOST_PULSE_SYSFS "/sys/devices/system/cpu/cpufreq/interactive/touchboostpulse"
-static const char cpufreq_boost_interactive[] = "/sys/devices/system/cpu/cpufreq/interactive/boost";
-static const char cpufreq_boost_intel_pstate[] = "/sys/devices/system/cpu/intel_pstate/min_perf_pct";
+/* governor floor in percent while a touch or a launch is held */
+#define GOVERNOR_TOUCH_BOOST_PCT 60
+#define GOVERNOR_LAUNCH_BOOST_PCT 100
 
-/*
- * This parameter is to identify continuous touch/scroll events.
- * Any two touch hints received between a 20 interval ms is
- * considered as a scroll event.
- */
-#define SHORT_TOUCH_TIME 20
-#define SCHEDTUNE_BOOST_PATH "/dev/stune/foreground/schedtune.boost"
-#define SCHEDTUNE_BOOST_NORM "10"
-#define SCHEDTUNE_BOOST_INTERACTIVE "40"
-#define SCHEDTUNE_BOOST_TIME_NS 1000000000LL
+/* how long top-app stays on the P-cores after the last touch */
+#define TOP_APP_PIN_TIME_NS 1000000000LL
 #define container_of(addr, struct_name, field_name) \
     ((struct_name *)((char *)(addr) - offsetof(struct_name, field_name)))
 
+static CGroupCpusetController cgroupCpusetController;
+static TouchClassifier touchClassifier;
+static TouchPredictor touchPredictor;
+/* touch and boost parameters; the hint path reads a published snapshot */
+static PowerTunables tunables;
+static DevicePowerMonitor powerMonitor;
+/* debounced, staged screen-off; a quick screen-on cancels what has not run */
+static ScreenStateController screenState;
+enum {
+    SCREEN_STAGE_CPUSET = 0,
+    SCREEN_STAGE_DEVICES,
+    SCREEN_STAGE_CRITICAL,
+    SCREEN_STAGE_NUM
+};
+/* HWP energy/performance preference per power mode, when available */
+static EppController eppController;
+/* thermal-headroom frequency cap for sustained performance and VR */
+static SustainedController sustainedController;
+static bool sustainedHintActive = false;
+static bool vrHintActive = false;
+static bool serviceRegistered = false;
+/* CPU frequency boost backend, resolved once by the boot thread */
+static NullGovernor nullGovernor;
+static GovernorBackend *governor = &nullGovernor;
+/* schedtune or uclamp.min of the foreground groups, resolved by the boot thread */
+static CGroupBoostController cgroupBoost;
+/* i915 render clock floor, when card0 has one */
+static GpuBoostController gpuBoost;
+/* PSI and utilisation driven touch level, on devices that enable it */
+static AdaptiveBoostController adaptiveBoost;
+
 /*
- * This parameter is to identify first touch events.
- * Any two touch hints received after 100 ms is considered as
- * a first touch event.
+ * power_hint only posts desired node values; the actuator thread does the
+ * blocking writes so SurfaceFlinger/InputDispatcher never wait on sysfs.
  */
-#define LONG_TOUCH_TIME 100
+static SysfsActuator actuator;
 
 /*
- * This parameter defines the number of vsync boost to be
- * done after the finger release event.
+ * Every duration-based boost is a lease on the scheduler; the expiry
+ * callback restores the knob from the scheduler thread.
  */
-#define VSYNC_BOOST_COUNT 4
+static BoostScheduler boostScheduler;
+static int touchboostLease = -1;
+static int appLaunchLease = -1;
+static int topAppPinLease = -1;
+static int touchPredictLease = -1;
+static int gpuTouchLease = -1;
+static int adaptiveLease = -1;
 
 /*
- * This parameter defines the time between a touch and a vsync
- * hint. the time if is > 30 ms, we do a vsync boost.
+ * Knobs shared by several boosts are owned by the arbiter; every boost
+ * places its own request and the arbiter writes the aggregate. Requests
+ * are made from lease callbacks, so the arbiter lock nests under the
+ * lease locks and never the other way round.
  */
-#define VSYNC_TOUCH_TIME 30
+static BoostArbiter boostArbiter;
+enum {
+    REQUESTER_INTERACTION = 0,
+    REQUESTER_LAUNCH,
+    REQUESTER_PREDICT,
+    REQUESTER_SUSTAINED,
+    REQUESTER_ADAPTIVE,
+};
 
-static CGroupCpusetController cgroupCpusetController;
-static DevicePowerMonitor powerMonitor;
-static bool serviceRegistered = false;
-static bool interactiveActive = false;
-static bool intelPStateActive = false;
-static bool intelSchedBoostActive = false;
+/*
+ * Time callers spend in power_hint, waiting for the lock and in total per
+ * hint type. Recording is lock-free; powerhal_dump() prints everything.
+ */
+#define POWERHAL_STATS_FILE "/data/vendor/powerhal/stats.txt"
+/* debug captures for the offline classifier replay (bench/hint_replay) */
+#define POWERHAL_TRACE_FILE "/data/vendor/powerhal/hints.trace"
+enum {
+    HINT_STATS_VSYNC = 0,
+    HINT_STATS_INTERACTION,
+    HINT_STATS_LOW_POWER,
+    HINT_STATS_SUSTAINED,
+    HINT_STATS_APP_LAUNCH,
+    HINT_STATS_OTHER,
+    HINT_STATS_NUM
+};
+static LatencyHistogram hintLockWaitHist("hint_lock_wait");
+static LatencyHistogram hintTotalHist[HINT_STATS_NUM] = {
+    { "hint_vsync" },
+    { "hint_interaction" },
+    { "hint_low_power" },
+    { "hint_sustained" },
+    { "hint_app_launch" },
+    { "hint_other" },
+};
+static HintRecorder hintRecorder;
+/*
+ * The bugreport snapshot is written by its own thread: screen-off only
+ * flags it, so the caller never waits on /data or on the dump locks.
+ */
+static pthread_mutex_t statsDumpLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t statsDumpCond = PTHREAD_COND_INITIALIZER;
+static bool statsDumpRequested = false;
+static bool statsDumpStarted = false;
+
+/*
+ * Set under hintLock while the classifier can still turn a vsync into a
+ * pulse; every other vsync returns before taking the lock.
+ */
+static std::atomic<bool> vsyncBoostArmed(false);
+static std::atomic<uint32_t> vsyncEarlyOuts(0);
+/* governor level the predicted touch lease holds */
+static std::atomic<int> touchPredictLevel(GOVERNOR_TOUCH_BOOST_PCT);
+/* bursts of pulses and lease re-arms actuate once per coalescing window */
+static HintCoalescer touchboostCoalescer("touchboost_pulse");
+static HintCoalescer interactionCoalescer("interaction_rearm");
 
 struct intel_power_module{
     struct power_module container;
-    int touchboost_disable;
-    int timer_set;
-    int vsync_boost;
-    pthread_mutex_t lock;
-    int schedtune_boost_fd;
-    long long deboost_time;
-    sem_t signal_lock;
 };
 
-static int sysfs_write(const char *path, char *s)
-{
-    char buf[80];
-    int len;
-    int fd = open(path, O_WRONLY);
+/*
+ * Serialises the hint heuristics and mode state. Both front ends take it
+ * for legacy hints and mode changes; timed boosts never do.
+ */
+static pthread_mutex_t hintLock = PTHREAD_MUTEX_INITIALIZER;
 
-    if (fd < 0) {
-        strerror_r(errno, buf, sizeof(buf));
-        ALOGE("Error opening %s: %s\n", path, buf);
-        return -1;
-    }
+/*
+ * powerhal_init only starts the boot thread, which probes the backends
+ * while a second thread enables the devices. Until it is done every
+ * entry point records its request here instead of acting on it. Each
+ * kind of request keeps only its latest value: interactive and modes
+ * are state, and a later boost covers an earlier one, so nothing that
+ * matters is ever lost. Vsyncs carry nothing worth replaying. The boot
+ * thread takes everything pending under bootLock, replays it without
+ * the lock and repeats until nothing is left, then sets halReady, so
+ * nothing recorded can be overtaken.
+ */
+#define BOOT_MODES (POWERHAL_MODE_LAUNCH + 1)
+enum {
+    BOOT_OP_HINT = 0,            /* only the interaction hint is kept */
+    BOOT_OP_INTERACTIVE,
+    BOOT_OP_MODE,
+    BOOT_OP_BOOST_INTERACTION,
+    BOOT_OP_BOOST_DISPLAY_UPDATE,
+    BOOT_OP_BOOST_LAUNCH,
+    BOOT_OPS
+};
+struct BootPending {
+    /* latest values, only meaningful once set */
+    bool interactiveSet;
+    bool interactive;
+    bool modeSet[BOOT_MODES];
+    bool modes[BOOT_MODES];
+    /* timed boosts by op; hint data is only ever a value, never dereferenced */
+    bool boostSet[BOOT_OPS];
+    long long boostValue[BOOT_OPS];
+};
+static BootPending bootPending;
+static int bootReplayed = 0;
+/* early requests folded into a later one of the same kind */
+static unsigned int bootFolded = 0;
+static long long bootStartNs = 0;
+static long long bootDoneNs = 0;
+static std::atomic<bool> halReady(false);
+static pthread_mutex_t bootLock = PTHREAD_MUTEX_INITIALIZER;
 
-    len = write(fd, s, strlen(s));
-    if (len < 0) {
-        strerror_r(errno, buf, sizeof(buf));
-        ALOGE("Error writing to %s: %s\n", path, buf);
-        close(fd);
-        return -1;
+static void hal_boost_launch(long long durationNs);
+
+#ifdef APP_LAUNCH_BOOST
+static void app_launch_boost(void *hint_data)
+{
+    /*
+     * The launch-end hint releases the lease; the timeout covers a
+     * missing one so the cores never stay pinned.
+     */
+    if (hint_data != NULL) {
+        ALOGI("PowerHAL HAL:App Boost ON");
+        hal_boost_launch(0);
+    } else {
+        ALOGI("PowerHAL HAL:App Boost OFF");
+        boostScheduler.release(appLaunchLease);
     }
+}
+#endif
 
-    close(fd);
-    return 0;
+#define NSEC_PER_SEC 1000000000LL
+static long long gettime_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
 }
 
-static int sysfs_read(const char *path, char *s, int length)
+/*
+ * With the adaptive loop running the fixed touch requests only keep its
+ * floor, so the loop can take the level below the fixed one as well.
+ */
+static int touch_boost_level(int fixed)
 {
-    char buf[80];
-    int len;
-    int fd = open(path, O_RDONLY);
+    Tunables t = tunables.get();
 
-    if (fd < 0) {
-        strerror_r(errno, buf, sizeof(buf));
-        ALOGE("Error opening %s: %s\n", path, buf);
-        return -1;
-    }
+    if (adaptiveLease >= 0 && t.adaptiveBoost && t.adaptiveMin < fixed)
+        return t.adaptiveMin;
+    return fixed;
+}
 
-    len = read(fd, s, length);
-    if (len < 0) {
-        strerror_r(errno, buf, sizeof(buf));
-        ALOGE("Error reading from %s: %s\n", path, buf);
-        close(fd);
-        return -1;
-    }
+static void touch_predict_lease_start(__attribute__((unused))void *arg)
+{
+    governor->hold(REQUESTER_PREDICT,
+                   touch_boost_level(touchPredictLevel.load(std::memory_order_relaxed)));
+}
 
-    close(fd);
-    return 0;
+static void touch_predict_lease_expire(__attribute__((unused))void *arg)
+{
+    governor->hold(REQUESTER_PREDICT, 0);
 }
 
-#ifdef APP_LAUNCH_BOOST
-static void app_launch_boost_interactive(void *hint_data)
+/*
+ * A running lease takes the new level right away, a new one on start.
+ * Holding before the arm keeps an expiry in between from leaving it set.
+ */
+static void touch_predict_arm(long long durationNs, int level)
 {
-    if (hint_data != NULL) {
-        ALOGI("PowerHAL HAL:App Boost ON");
-        sysfs_write(cpufreq_boost_interactive,(char *)"1");
-    } else {
-        ALOGI("PowerHAL HAL:App Boost OFF");
-        sysfs_write(cpufreq_boost_interactive,(char *)"0");
-    }
+    if (touchPredictLevel.exchange(level, std::memory_order_relaxed) != level &&
+            boostScheduler.isActive(touchPredictLease))
+        governor->hold(REQUESTER_PREDICT, touch_boost_level(level));
+    boostScheduler.arm(touchPredictLease, durationNs);
 }
 
-static void app_launch_boost_intel_pstate(void *hint_data)
+/* the GPU ramps slower than the CPU, so touch raises its floor too */
+static void gpu_touch_lease_start(__attribute__((unused))void *arg)
 {
-    static char old_min_perf_pct[4];
-    static bool boosted = false;
+    gpuBoost.hold(REQUESTER_INTERACTION, tunables.get().gpuTouchBoost);
+}
 
-    if (hint_data != NULL) {
-        ALOGI("PowerHAL HAL:App Boost ON");
-        if (boosted == false) {
-            if (!sysfs_read(cpufreq_boost_intel_pstate, old_min_perf_pct, sizeof(old_min_perf_pct))) {
-                sysfs_write(cpufreq_boost_intel_pstate,(char *)"100");
-                boosted = true;
-            }
-        }
-    } else {
-        ALOGI("PowerHAL HAL:App Boost OFF");
-        if (boosted == true) {
-            sysfs_write(cpufreq_boost_intel_pstate, old_min_perf_pct);
-            boosted = false;
-        }
-    }
+static void gpu_touch_lease_expire(__attribute__((unused))void *arg)
+{
+    gpuBoost.hold(REQUESTER_INTERACTION, 0);
 }
 
-#endif
+/* called from the adaptive loop thread; the level goes where touch boosts go */
+static void adaptive_boost_apply(int level, __attribute__((unused))void *arg)
+{
+    if (governor->touchBoost())
+        governor->hold(REQUESTER_ADAPTIVE, level);
+    else if (level)
+        cgroupBoost.request(REQUESTER_ADAPTIVE, level);
+    else
+        cgroupBoost.cancel(REQUESTER_ADAPTIVE);
+}
 
-#define NSEC_PER_SEC 1000000000LL
-static long long gettime_ns(void)
+/* a session starts from the fixed touch level and stays in the tuned range */
+static void adaptive_lease_start(__attribute__((unused))void *arg)
 {
-    struct timespec ts;
-    clock_gettime(CLOCK_MONOTONIC, &ts);
-    return ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+    Tunables t = tunables.get();
+    int level = governor->touchBoost() ? GOVERNOR_TOUCH_BOOST_PCT : t.touchBoost;
+
+    if (level)
+        adaptiveBoost.begin(level, t.adaptiveMin, t.adaptiveMax);
 }
 
-static void nanosleep_ns(long long ns)
+static void adaptive_lease_expire(__attribute__((unused))void *arg)
 {
-    struct timespec ts;
-    ts.tv_sec = ns/NSEC_PER_SEC;
-    ts.tv_nsec = ns%NSEC_PER_SEC;
-    nanosleep(&ts, NULL);
+    adaptiveBoost.end();
+}
+
+/*
+ * The launch boost raises every knob the platform has. On HWP parts the
+ * EPP launch mode replaces the governor floor. Knobs without an arbiter
+ * entry on this platform ignore the request.
+ */
+static void app_launch_lease_start(__attribute__((unused))void *arg)
+{
+    if (eppController.active())
+        eppController.requestMode(EppController::MODE_LAUNCH, true);
+    else
+        governor->hold(REQUESTER_LAUNCH, GOVERNOR_LAUNCH_BOOST_PCT);
+    cgroupBoost.request(REQUESTER_LAUNCH, tunables.get().launchBoost);
+    gpuBoost.hold(REQUESTER_LAUNCH, tunables.get().gpuLaunchBoost);
+    cgroupCpusetController.requestProfile(CGroupCpusetController::PROFILE_LAUNCH, true);
+}
+
+static void app_launch_lease_expire(__attribute__((unused))void *arg)
+{
+    cgroupCpusetController.requestProfile(CGroupCpusetController::PROFILE_LAUNCH, false);
+    cgroupBoost.cancel(REQUESTER_LAUNCH);
+    gpuBoost.hold(REQUESTER_LAUNCH, 0);
+    if (eppController.active())
+        eppController.requestMode(EppController::MODE_LAUNCH, false);
+    else
+        governor->hold(REQUESTER_LAUNCH, 0);
+}
+
+static void top_app_pin_lease_start(__attribute__((unused))void *arg)
+{
+    cgroupCpusetController.requestProfile(CGroupCpusetController::PROFILE_TOUCH, true);
+}
+
+static void top_app_pin_lease_expire(__attribute__((unused))void *arg)
+{
+    cgroupCpusetController.requestProfile(CGroupCpusetController::PROFILE_TOUCH, false);
+}
+
+/*
+ * Called from the sustained loop thread. HWP parts clamp the EPP window,
+ * otherwise the governor backend carries the cap, if it has one.
+ */
+static void sustained_cap(int capPct, __attribute__((unused))void *arg)
+{
+    if (eppController.active())
+        eppController.setMaxCap(capPct);
+    else
+        governor->cap(REQUESTER_SUSTAINED, capPct);
+}
+
+/* sustained performance and VR mode share the sustained profiles */
+static void sustained_mode_update(void)
+{
+    bool on = sustainedHintActive || vrHintActive;
+
+    cgroupCpusetController.requestProfile(CGroupCpusetController::PROFILE_SUSTAINED, on);
+    eppController.requestMode(EppController::MODE_SUSTAINED, on);
+    sustainedController.request(SustainedController::SOURCE_SUSTAINED, sustainedHintActive);
+    sustainedController.request(SustainedController::SOURCE_VR, vrHintActive);
+    if (on)
+        cgroupBoost.request(REQUESTER_SUSTAINED, tunables.get().sustainedBoost);
+    else
+        cgroupBoost.cancel(REQUESTER_SUSTAINED);
+}
+
+static void boost_leases_init(void)
+{
+    /*
+     * The interactive governor times touchboostpulse itself; the lease
+     * only tracks how long the pulse keeps the cores boosted.
+     */
+    touchboostLease = boostScheduler.addLease("touchboost", NULL, NULL, NULL);
+    /* predictive mode holds the boost level for the predicted gesture */
+    touchPredictLease = boostScheduler.addLease("touch_predict",
+            touch_predict_lease_start, touch_predict_lease_expire, NULL);
+    if (gpuBoost.active())
+        gpuTouchLease = boostScheduler.addLease("gpu_touch",
+                gpu_touch_lease_start, gpu_touch_lease_expire, NULL);
+    if (adaptiveBoost.active())
+        adaptiveLease = boostScheduler.addLease("adaptive",
+                adaptive_lease_start, adaptive_lease_expire, NULL);
+    appLaunchLease = boostScheduler.addLease("app_launch",
+            app_launch_lease_start, app_launch_lease_expire, NULL);
+    if (cgroupCpusetController.topology().isHybrid())
+        topAppPinLease = boostScheduler.addLease("top_app_pin",
+                top_app_pin_lease_start, top_app_pin_lease_expire, NULL);
+    boostScheduler.start();
+}
+
+static void screen_off_cpuset(__attribute__((unused))void *arg)
+{
+    cgroupCpusetController.setState(0);
+    eppController.setState(0);
 }
 
-int schedtune_sysfs_boost(struct intel_power_module *intel, char* booststr)
+static void screen_off_devices(__attribute__((unused))void *arg)
 {
-    char buf[80];
-    int len;
-    len = write(intel->schedtune_boost_fd, booststr, 2);
+    powerMonitor.setState(0, DevicePowerMonitorInfo::PHASE_NORMAL,
+                          DevicePowerMonitorInfo::PHASE_LATE);
+}
+
+static void screen_off_critical(__attribute__((unused))void *arg)
+{
+    powerMonitor.setState(0, DevicePowerMonitorInfo::PHASE_CRITICAL,
+                          DevicePowerMonitorInfo::PHASE_CRITICAL);
+}
+
+/* runs only if some stage did; devices that were never suspended are skipped */
+static void screen_on_resume(__attribute__((unused))void *arg)
+{
+    /* widen the cpuset first so the resume work itself can spread out */
+    cgroupCpusetController.setState(1);
+    eppController.setState(1);
+    powerMonitor.setState(1);
+}
+
+static void screen_stages_init(void)
+{
+    screenState.addStage("cpuset", screen_off_cpuset, NULL);
+    screenState.addStage("devices", screen_off_devices, NULL);
+    screenState.addStage("critical", screen_off_critical, NULL);
+    screenState.setResume(screen_on_resume, NULL);
+    screenState.start();
+}
+
+static void touchboost_pulse(long long nowNs)
+{
+    if (!touchboostCoalescer.pass(nowNs, tunables.get().coalesceNs))
+        return;
+    governor->pulse();
+    boostScheduler.arm(touchboostLease, governor->pulseNs());
+}
+
+static void cgroup_touch_boost(long long durationNs)
+{
+    Tunables t = tunables.get();
+
+    cgroupBoost.request(REQUESTER_INTERACTION, touch_boost_level(t.touchBoost),
+                        durationNs > 0 ? durationNs : t.touchBoostNs);
+}
+
+/* the adaptive session lasts as long as the cgroup touch boost would */
+static void adaptive_boost_arm(long long durationNs)
+{
+    Tunables t = tunables.get();
 
-    if (len < 0) {
-        strerror_r(errno, buf, sizeof(buf));
-        ALOGE("Error writing to %s: %s\n", SCHEDTUNE_BOOST_PATH, buf);
+    if (adaptiveLease >= 0 && t.adaptiveBoost)
+        boostScheduler.arm(adaptiveLease, durationNs > 0 ? durationNs : t.touchBoostNs);
+}
+
+static int hint_stats_index(power_hint_t hint)
+{
+    switch (hint) {
+    case POWER_HINT_VSYNC:
+        return HINT_STATS_VSYNC;
+    case POWER_HINT_INTERACTION:
+        return HINT_STATS_INTERACTION;
+    case POWER_HINT_LOW_POWER:
+        return HINT_STATS_LOW_POWER;
+    case POWER_HINT_SUSTAINED_PERFORMANCE:
+    case POWER_HINT_VR_MODE:
+        return HINT_STATS_SUSTAINED;
+#if defined(APP_LAUNCH_BOOST) && defined(APP_LAUNCH_BOOST_SUPPORTED)
+    case POWER_HINT_APP_LAUNCH:
+        return HINT_STATS_APP_LAUNCH;
+#endif
+    default:
+        return HINT_STATS_OTHER;
     }
-    return len;
-}
-
-static void* schedtune_deboost_thread(void* arg)
-{
-    struct intel_power_module *intel = (struct intel_power_module *)arg;
-    while(1) {
-        sem_wait(&intel->signal_lock);
-        while(1) {
-            long long now, sleeptime = 0;
-            pthread_mutex_lock(&intel->lock);
-            now = gettime_ns();
-            if (intel->deboost_time > now) {
-                sleeptime = intel->deboost_time - now;
-                pthread_mutex_unlock(&intel->lock);
-                nanosleep_ns(sleeptime);
-		continue;
-            }
+}
 
-            schedtune_sysfs_boost(intel,(char*)SCHEDTUNE_BOOST_NORM);
-            intel->deboost_time = 0;
-            pthread_mutex_unlock(&intel->lock);
-            break;
-        }
+void powerhal_dump(int fd)
+{
+    int i;
+
+    /* the controllers are still being probed on the boot thread */
+    if (!halReady.load(std::memory_order_acquire)) {
+        dprintf(fd, "PowerHAL: initialising for %lld ms\n",
+                (gettime_ns() - bootStartNs) / 1000000LL);
+        return;
     }
-    return NULL;
+    dprintf(fd, "PowerHAL: governor=%s cgroup_boost=%s\n", governor->name(),
+            cgroupBoost.name());
+    dprintf(fd, "boot: ready after %lld ms, %d early requests replayed, %u folded\n",
+            (bootDoneNs - bootStartNs) / 1000000LL, bootReplayed, bootFolded);
+    dprintf(fd, "hints:\n");
+    hintLockWaitHist.dump(fd);
+    dprintf(fd, "  vsync early-outs=%u\n", vsyncEarlyOuts.load(std::memory_order_relaxed));
+    touchboostCoalescer.dump(fd);
+    interactionCoalescer.dump(fd);
+    for (i = 0; i < HINT_STATS_NUM; i++)
+        hintTotalHist[i].dump(fd);
+    actuator.dump(fd);
+    governor->dump(fd);
+    cgroupBoost.dump(fd);
+    gpuBoost.dump(fd);
+    adaptiveBoost.dump(fd);
+    boostScheduler.dump(fd);
+    boostArbiter.dump(fd);
+    cgroupCpusetController.dump(fd);
+    eppController.dump(fd);
+    sustainedController.dump(fd);
+    screenState.dump(fd);
+    powerMonitor.dump(fd);
+    tunables.dump(fd);
+    hintRecorder.dump(fd);
 }
 
-static void schedtune_boost(struct intel_power_module *intel)
+/* snapshot for bugreports; only written when the directory exists */
+static void power_dump_to_file(void)
 {
-    long long now;
-    now = gettime_ns();
+    int fd = open(POWERHAL_STATS_FILE, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0640);
+
+    if (fd < 0)
+        return;
+    powerhal_dump(fd);
+    close(fd);
 
-    if (!intel->deboost_time) {
-        schedtune_sysfs_boost(intel,(char*)SCHEDTUNE_BOOST_INTERACTIVE);
-        sem_post(&intel->signal_lock);
+    if (!hintRecorder.enabled())
+        return;
+    fd = open(POWERHAL_TRACE_FILE, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0640);
+    if (fd < 0)
+        return;
+    if (hintRecorder.save(fd))
+        ALOGE("Error saving hint trace: %s", strerror(errno));
+    close(fd);
+}
+
+static void *stats_dump_thread(__attribute__((unused))void *arg)
+{
+    pthread_mutex_lock(&statsDumpLock);
+    while (1) {
+        while (!statsDumpRequested)
+            pthread_cond_wait(&statsDumpCond, &statsDumpLock);
+        statsDumpRequested = false;
+        pthread_mutex_unlock(&statsDumpLock);
+        power_dump_to_file();
+        pthread_mutex_lock(&statsDumpLock);
     }
-    intel->deboost_time = now + SCHEDTUNE_BOOST_TIME_NS;
-    return;
+    return NULL;
 }
 
-static int schedtune_power_init(struct intel_power_module *intel)
+static void stats_dump_init(void)
 {
-    char buf[50];
-    pthread_t tid;
-    intel->deboost_time = 0;
-    sem_init(&intel->signal_lock, 0, 1);
-    intel->schedtune_boost_fd = open(SCHEDTUNE_BOOST_PATH, O_WRONLY);
+    pthread_attr_t attr;
+    pthread_t thread;
 
-    if (intel->schedtune_boost_fd < 0) {
-        strerror_r(errno, buf, sizeof(buf));
-        ALOGE("Error opening %s: %s\n", SCHEDTUNE_BOOST_PATH, buf);
-        sem_close(&intel->signal_lock);
-        return -1;
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    statsDumpStarted = !pthread_create(&thread, &attr, stats_dump_thread, NULL);
+    pthread_attr_destroy(&attr);
+    if (!statsDumpStarted)
+        ALOGW("Could not start the stats dump thread, no screen-off snapshots");
+}
+
+/* screen-offs arriving while a snapshot is pending fold into it */
+static void stats_dump_request(void)
+{
+    if (!statsDumpStarted)
+        return;
+    pthread_mutex_lock(&statsDumpLock);
+    statsDumpRequested = true;
+    pthread_cond_signal(&statsDumpCond);
+    pthread_mutex_unlock(&statsDumpLock);
+}
+
+static void hal_set_interactive(bool on)
+{
+    Tunables t = tunables.get();
+    long long delaysNs[SCREEN_STAGE_NUM];
+
+    if (on) {
+        screenState.screenOn();
+        return;
     }
-    pthread_create(&tid, NULL, schedtune_deboost_thread, intel);
-    return 0;
+    delaysNs[SCREEN_STAGE_CPUSET] = t.screenOffCpusetNs;
+    delaysNs[SCREEN_STAGE_DEVICES] = t.screenOffDevicesNs;
+    delaysNs[SCREEN_STAGE_CRITICAL] = t.screenOffCriticalNs;
+    screenState.screenOff(delaysNs);
+
+    /* screen-off is a cheap point to refresh the stats snapshot */
+    stats_dump_request();
 }
 
-static void power_init(__attribute__((unused))struct power_module *module)
+/* called with hintLock held */
+static void set_mode_locked(int mode, bool on)
+{
+    switch (mode) {
+    case POWERHAL_MODE_LOW_POWER:
+        cgroupCpusetController.requestProfile(CGroupCpusetController::PROFILE_LOW_POWER, on);
+        eppController.requestMode(EppController::MODE_LOW_POWER, on);
+        break;
+    case POWERHAL_MODE_SUSTAINED_PERFORMANCE:
+        sustainedHintActive = on;
+        sustained_mode_update();
+        break;
+    case POWERHAL_MODE_VR:
+        vrHintActive = on;
+        sustained_mode_update();
+        break;
+    case POWERHAL_MODE_LAUNCH:
+        if (on)
+            hal_boost_launch(0);
+        else
+            boostScheduler.release(appLaunchLease);
+        break;
+    default:
+        break;
+    }
+}
+
+static void hal_set_mode(int mode, bool on)
 {
-    int cnt = 0;
-    char buf[1];
-    struct intel_power_module *intel = container_of(module,struct intel_power_module, container);
+    pthread_mutex_lock(&hintLock);
+    set_mode_locked(mode, on);
+    pthread_mutex_unlock(&hintLock);
+}
 
-    /* Enable all devices by default */
-    powerMonitor.setState(ENABLE);
-    cgroupCpusetController.setState(ENABLE);
+/*
+ * The framework passes the gesture length, so the boost is one lease of
+ * that length: the predictive lease holds the governor floor, governors
+ * that leave touch alone get the cgroup boost.
+ */
+static void hal_boost_interaction(long long durationNs)
+{
+    Tunables t = tunables.get();
 
-    if (!sysfs_read(TOUCHBOOST_PULSE_SYSFS, buf, 1))
-        interactiveActive = true;
-    if (!sysfs_read(cpufreq_boost_intel_pstate, buf, 1))
-	intelPStateActive = true;
-    if (!schedtune_power_init(intel))
-	intelSchedBoostActive = true;
+    if (topAppPinLease >= 0)
+        boostScheduler.arm(topAppPinLease, durationNs > 0 ? durationNs : TOP_APP_PIN_TIME_NS);
+    if (gpuTouchLease >= 0)
+        boostScheduler.arm(gpuTouchLease, durationNs > 0 ? durationNs : t.gpuTouchBoostNs);
+    adaptive_boost_arm(durationNs);
+    if (governor->touchBoost())
+        touch_predict_arm(durationNs > 0 ? durationNs : t.touch.predictBaseBoostMs * 1000000LL,
+                          GOVERNOR_TOUCH_BOOST_PCT);
+    else
+        cgroup_touch_boost(durationNs);
 }
 
-static void power_set_interactive(__attribute__((unused))struct power_module *module, int on)
+static void hal_boost_display_update(void)
 {
-    powerMonitor.setState(on);
-    cgroupCpusetController.setState(on);
+    if (governor->hasPulse())
+        touchboost_pulse(gettime_ns());
 }
 
-static void power_hint(struct power_module *module, power_hint_t hint,
-                       void *data)
+static void hal_boost_launch(long long durationNs)
 {
-    struct intel_power_module *intel = (struct intel_power_module *) module;
-    static struct timespec curr_time, prev_time = {0,0}, vsync_time;
-    double diff;
-    static int vsync_count;
-    static int consecutive_touch_int;
+    boostScheduler.arm(appLaunchLease,
+                       durationNs > 0 ? durationNs : tunables.get().appLaunchTimeoutNs);
+}
+
+static void hal_hint(power_hint_t hint, void *data)
+{
+    /* one copy for the hint, so a reload cannot switch the params halfway */
+    TouchParams touchParams;
+    long long start = gettime_ns();
+    bool rearm;
 
-    pthread_mutex_lock(&intel->lock);
+    hintRecorder.record(start, hint, (uint32_t)(uintptr_t)data);
+    /* covers governors without a pulse and predictive mode too */
+    if (hint == POWER_HINT_VSYNC && !vsyncBoostArmed.load(std::memory_order_relaxed)) {
+        vsyncEarlyOuts.fetch_add(1, std::memory_order_relaxed);
+        hintTotalHist[HINT_STATS_VSYNC].record(gettime_ns() - start);
+        return;
+    }
+    pthread_mutex_lock(&hintLock);
+    hintLockWaitHist.record(gettime_ns() - start);
     switch(hint) {
     case POWER_HINT_INTERACTION:
-        if (!interactiveActive) {
-            if (!intelSchedBoostActive) {
-                break;
-          } else {
-                schedtune_boost(intel);
-                break;
-            }
-        }
+        /* within a burst a re-arm would move the same deadlines by less than the window */
+        rearm = interactionCoalescer.pass(start, tunables.get().coalesceNs);
+        /* hybrid parts: keep the touched app on the P-cores for the gesture */
+        if (rearm && topAppPinLease >= 0)
+            boostScheduler.arm(topAppPinLease, TOP_APP_PIN_TIME_NS);
+        if (rearm && gpuTouchLease >= 0)
+            boostScheduler.arm(gpuTouchLease, tunables.get().gpuTouchBoostNs);
+        if (rearm)
+            adaptive_boost_arm(0);
 
-        clock_gettime(CLOCK_MONOTONIC, &curr_time);
-        diff = (curr_time.tv_sec - prev_time.tv_sec) * 1000 +
-               (double)(curr_time.tv_nsec - prev_time.tv_nsec) / 1e6;
-        prev_time = curr_time;
-        if (diff < SHORT_TOUCH_TIME) {
-            consecutive_touch_int++;
-        }
-        else if (diff > LONG_TOUCH_TIME) {
-            intel->vsync_boost = 0;
-            intel->timer_set = 0;
-            intel->touchboost_disable = 0;
-            vsync_count = 0;
-            consecutive_touch_int = 0;
+        if (!governor->touchBoost()) {
+            if (rearm)
+                cgroup_touch_boost(0);
+            break;
         }
-        /* Simple touch: timer rate need not be changed here */
-        if ((diff < SHORT_TOUCH_TIME) && (intel->touchboost_disable == 0)
-                        && (consecutive_touch_int > 4))
-            intel->touchboost_disable = 1;
+
         /*
-         * Scrolling: timer rate reduced to increase sensitivity. No more touch
-         * boost after this
+         * The classifier and the predictor still see every hint; level
+         * backends have no pulse, so they always take the predicted lease.
          */
-        if ((intel->touchboost_disable == 1) && (consecutive_touch_int > 15)
-                        && (intel->timer_set == 0)) {
-           intel->timer_set = 1;
-        }
-        if (!intel->touchboost_disable) {
-            sysfs_write(TOUCHBOOST_PULSE_SYSFS, (char *)"1");
+        touchParams = tunables.get().touch;
+        if (touchParams.predictive || !governor->hasPulse()) {
+            long long boostNs;
+
+            vsyncBoostArmed.store(false, std::memory_order_relaxed);
+            touchPredictor.setParams(touchParams);
+            boostNs = touchPredictor.onInteraction(start);
+            if (boostNs)
+                touch_predict_arm(boostNs,
+                                  GOVERNOR_TOUCH_BOOST_PCT * touchPredictor.levelPct() / 100);
+            break;
         }
+        touchClassifier.setParams(touchParams);
+        if (touchClassifier.onInteraction(start))
+            touchboost_pulse(start);
+        vsyncBoostArmed.store(touchClassifier.wantsVsync(), std::memory_order_relaxed);
         break;
     case POWER_HINT_VSYNC:
-        if (!interactiveActive) {
-            pthread_mutex_unlock(&intel->lock);
-            return;
-        }
-        if (intel->touchboost_disable == 1) {
-            clock_gettime(CLOCK_MONOTONIC, &vsync_time);
-            diff = (vsync_time.tv_sec - curr_time.tv_sec) * 1000 +
-            (double)(vsync_time.tv_nsec - curr_time.tv_nsec) / 1e6;
-            if (diff > VSYNC_TOUCH_TIME) {
-                intel->timer_set = 0;
-                intel->vsync_boost = 1;
-                intel->touchboost_disable = 0;
-                vsync_count = VSYNC_BOOST_COUNT;
-            }
-        }
-        if (intel->vsync_boost) {
-            if (((unsigned long)data != 0) && (vsync_count > 0)) {
-                sysfs_write(TOUCHBOOST_PULSE_SYSFS, (char *)"1");
-                vsync_count-- ;
-            if (vsync_count == 0)
-               intel->vsync_boost = 0;
-            }
+        touchParams = tunables.get().touch;
+        /* the predicted lease already covers the fling */
+        if (touchParams.predictive || !governor->hasPulse()) {
+            vsyncBoostArmed.store(false, std::memory_order_relaxed);
+            break;
         }
+        touchClassifier.setParams(touchParams);
+        if (touchClassifier.onVsync(start, data != NULL))
+            touchboost_pulse(start);
+        vsyncBoostArmed.store(touchClassifier.wantsVsync(), std::memory_order_relaxed);
         break;
     case POWER_HINT_LOW_POWER:
+        set_mode_locked(POWERHAL_MODE_LOW_POWER, data != NULL);
+        break;
+    case POWER_HINT_SUSTAINED_PERFORMANCE:
+        set_mode_locked(POWERHAL_MODE_SUSTAINED_PERFORMANCE, data != NULL);
+        break;
+    case POWER_HINT_VR_MODE:
+        set_mode_locked(POWERHAL_MODE_VR, data != NULL);
         break;
 
 #if defined(APP_LAUNCH_BOOST) && defined(APP_LAUNCH_BOOST_SUPPORTED)
     case POWER_HINT_APP_LAUNCH:
-        if (interactiveActive)
-            app_launch_boost_interactive(data);
-	else if (intelPStateActive)
-            app_launch_boost_intel_pstate(data);
+        app_launch_boost(data);
+        break;
 #endif
     default:
         break;
     }
-    pthread_mutex_unlock(&intel->lock);
+    pthread_mutex_unlock(&hintLock);
+    hintTotalHist[hint_stats_index(hint)].record(gettime_ns() - start);
+}
+
+static void *device_enable_thread(__attribute__((unused))void *arg)
+{
+    /* Enable all devices by default */
+    powerMonitor.setState(ENABLE);
+    return NULL;
+}
+
+static void boot_dispatch(int op, long long value)
+{
+    switch (op) {
+    case BOOT_OP_HINT:
+        hal_hint(POWER_HINT_INTERACTION, (void *)(intptr_t)value);
+        break;
+    case BOOT_OP_BOOST_INTERACTION:
+        hal_boost_interaction(value);
+        break;
+    case BOOT_OP_BOOST_DISPLAY_UPDATE:
+        hal_boost_display_update();
+        break;
+    case BOOT_OP_BOOST_LAUNCH:
+        hal_boost_launch(value);
+        break;
+    default:
+        break;
+    }
+}
+
+static void boot_replay(void)
+{
+    BootPending batch;
+    bool empty;
+    int m, op;
+
+    pthread_mutex_lock(&bootLock);
+    while (1) {
+        batch = bootPending;
+        memset(&bootPending, 0, sizeof(bootPending));
+        empty = !batch.interactiveSet;
+        for (m = 0; m < BOOT_MODES; m++)
+            empty &= !batch.modeSet[m];
+        for (op = 0; op < BOOT_OPS; op++)
+            empty &= !batch.boostSet[op];
+        if (empty)
+            break;
+        pthread_mutex_unlock(&bootLock);
+
+        /* state first, then the boosts made against it */
+        for (m = 0; m < BOOT_MODES; m++)
+            if (batch.modeSet[m]) {
+                hal_set_mode(m, batch.modes[m]);
+                bootReplayed++;
+            }
+        if (batch.interactiveSet) {
+            hal_set_interactive(batch.interactive);
+            bootReplayed++;
+        }
+        for (op = 0; op < BOOT_OPS; op++)
+            if (batch.boostSet[op]) {
+                boot_dispatch(op, batch.boostValue[op]);
+                bootReplayed++;
+            }
+
+        pthread_mutex_lock(&bootLock);
+    }
+    bootDoneNs = gettime_ns();
+    halReady.store(true, std::memory_order_release);
+    pthread_mutex_unlock(&bootLock);
+    ALOGI("PowerHAL ready after %lld ms, %d early requests replayed, %u folded",
+          (bootDoneNs - bootStartNs) / 1000000LL, bootReplayed, bootFolded);
+}
+
+/* the mode a legacy hint sets, or -1 for hints that are not state */
+static int boot_hint_mode(int hint)
+{
+    switch (hint) {
+    case POWER_HINT_LOW_POWER:
+        return POWERHAL_MODE_LOW_POWER;
+    case POWER_HINT_SUSTAINED_PERFORMANCE:
+        return POWERHAL_MODE_SUSTAINED_PERFORMANCE;
+    case POWER_HINT_VR_MODE:
+        return POWERHAL_MODE_VR;
+#if defined(APP_LAUNCH_BOOST) && defined(APP_LAUNCH_BOOST_SUPPORTED)
+    case POWER_HINT_APP_LAUNCH:
+        return POWERHAL_MODE_LAUNCH;
+#endif
+    default:
+        return -1;
+    }
+}
+
+/* true if the request was taken for the boot thread */
+static bool boot_defer(int op, int arg, long long value)
+{
+    int mode = -1;
+
+    if (halReady.load(std::memory_order_acquire))
+        return false;
+    if (op == BOOT_OP_MODE) {
+        mode = arg;
+    } else if (op == BOOT_OP_HINT) {
+        mode = boot_hint_mode(arg);
+        /* vsync and the rest only mean something once the HAL runs */
+        if (mode < 0 && arg != POWER_HINT_INTERACTION)
+            return true;
+    }
+
+    pthread_mutex_lock(&bootLock);
+    if (halReady.load(std::memory_order_relaxed)) {
+        pthread_mutex_unlock(&bootLock);
+        return false;
+    }
+    if (op == BOOT_OP_INTERACTIVE) {
+        bootFolded += bootPending.interactiveSet;
+        bootPending.interactiveSet = true;
+        bootPending.interactive = arg != 0;
+    } else if (op == BOOT_OP_MODE || mode >= 0) {
+        /* a mode this HAL does not know has nothing to replay */
+        if (mode >= 0 && mode < BOOT_MODES) {
+            bootFolded += bootPending.modeSet[mode];
+            bootPending.modeSet[mode] = true;
+            bootPending.modes[mode] = value != 0;
+        }
+    } else if (op >= 0 && op < BOOT_OPS) {
+        bootFolded += bootPending.boostSet[op];
+        bootPending.boostSet[op] = true;
+        bootPending.boostValue[op] = value;
+    }
+    pthread_mutex_unlock(&bootLock);
+    return true;
+}
+
+static void *boot_thread(__attribute__((unused))void *arg)
+{
+
+    pthread_t devices;
+    bool devicesAsync;
+
+    /* the device enable is the long pole and independent of everything below */
+    devicesAsync = !pthread_create(&devices, NULL, device_enable_thread, NULL);
+    if (!devicesAsync)
+        powerMonitor.setState(ENABLE);
+
+    cgroupCpusetController.probe();
+    cgroupCpusetController.setState(ENABLE);
+
+    /* every hint below goes through the backend picked here */
+    governor = GovernorBackend::select();
+    governor->attach(&actuator, &boostArbiter);
+    if (cgroupBoost.probe())
+        cgroupBoost.attach(&actuator, &boostArbiter);
+    if (gpuBoost.probe())
+        gpuBoost.attach(&actuator, &boostArbiter);
+    /* off unless the device opts in; the probe also needs PSI */
+    if (tunables.get().adaptiveBoost && adaptiveBoost.probe())
+        adaptiveBoost.setLevelCallback(adaptive_boost_apply, NULL);
+
+    cgroupCpusetController.attachActuator(&actuator);
+    if (eppController.probe()) {
+        eppController.attachActuator(&actuator);
+        eppController.setState(ENABLE);
+    }
+#ifdef POWERHAL_DEBUG
+    /* compare hint latency against inline writes */
+    actuator.setSynchronous(property_get_bool("persist.powerhal.sync_actuation", false));
+    /* capture the hint stream for offline classifier tuning */
+    hintRecorder.setEnabled(property_get_bool("persist.powerhal.hint_trace", false));
+#endif
+
+    actuator.start();
+    boostArbiter.start();
+    boost_leases_init();
+    screen_stages_init();
+    stats_dump_init();
+    /* without a cap the loop would only burn wakeups */
+    if (eppController.active() || governor->canCap()) {
+        sustainedController.probe();
+        sustainedController.setCapCallback(sustained_cap, NULL);
+        sustainedController.start();
+    } else {
+        ALOGI("The %s backend cannot cap frequency, sustained mode runs uncapped",
+              governor->name());
+    }
+    adaptiveBoost.start();
+
+    /* queued screen-offs must not race the initial enable */
+    if (devicesAsync)
+        pthread_join(devices, NULL);
+    boot_replay();
+    return NULL;
+}
+
+void powerhal_init(void)
+{
+    pthread_attr_t attr;
+    pthread_t thread;
+    int ret;
+
+    bootStartNs = gettime_ns();
+    tunables.load();
+    tunables.startWatcher();
+
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    ret = pthread_create(&thread, &attr, boot_thread, NULL);
+    pthread_attr_destroy(&attr);
+    if (ret) {
+        ALOGW("Could not start the boot thread, initialising inline");
+        boot_thread(NULL);
+    }
+}
+
+void powerhal_set_interactive(bool on)
+{
+    if (!boot_defer(BOOT_OP_INTERACTIVE, on, 0))
+        hal_set_interactive(on);
+}
+
+void powerhal_set_mode(int mode, bool on)
+{
+    if (!boot_defer(BOOT_OP_MODE, mode, on))
+        hal_set_mode(mode, on);
+}
+
+void powerhal_boost_interaction(long long durationNs)
+{
+    if (!boot_defer(BOOT_OP_BOOST_INTERACTION, 0, durationNs))
+        hal_boost_interaction(durationNs);
+}
+
+void powerhal_boost_display_update(void)
+{
+    if (!boot_defer(BOOT_OP_BOOST_DISPLAY_UPDATE, 0, 0))
+        hal_boost_display_update();
+}
+
+void powerhal_boost_launch(long long durationNs)
+{
+    if (!boot_defer(BOOT_OP_BOOST_LAUNCH, 0, durationNs))
+        hal_boost_launch(durationNs);
+}
+
+void powerhal_hint(power_hint_t hint, void *data)
+{
+    if (!boot_defer(BOOT_OP_HINT, hint, (intptr_t)data))
+        hal_hint(hint, data);
+}
+
+/* legacy passthrough module */
+static void power_init(__attribute__((unused))struct power_module *module)
+{
+    powerhal_init();
+}
+
+static void power_set_interactive(__attribute__((unused))struct power_module *module, int on)
+{
+    powerhal_set_interactive(on != 0);
+}
+
+static void power_hint(__attribute__((unused))struct power_module *module, power_hint_t hint,
+                       void *data)
+{
+    powerhal_hint(hint, data);
 }
 
 static struct hw_module_methods_t power_module_methods = {
@@ -396,7 +1051,4 @@ struct intel_power_module HAL_MODULE_INFO_SYM = {
     .setInteractive = power_set_interactive,
     .powerHint = power_hint,
     },
-    touchboost_disable: 0,
-    timer_set: 0,
-    vsync_boost: 0,
 };